@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "model/ProgramModel.hpp"
+
+// Microbenchmarks for the solver hot paths plus end-to-end solves over a puzzle directory.
+// Usage: rushhour_bench [--dir test] [--format json|csv] [--out file] [--min-time seconds]
+//                       [--algos a*,ucs,...] [--heuristic name]
+
+namespace {
+    struct Options {
+        std::string directory = "test";
+        std::string format = "json";
+        std::string output;
+        double min_time = 0.2;
+        std::vector<std::string> algorithms = {"a*", "ucs", "gbfs", "ida*", "hda*", "bibfs", "retrograde"};
+        std::string heuristics = "blockedcarheuristic";
+    };
+
+    struct MicroResult {
+        std::string board;
+        std::string name;
+        uint64_t iterations;
+        double ns_per_op;
+    };
+
+    struct SolveResult {
+        std::string board;
+        std::string algorithm;
+        std::string status;
+        int moves;
+        int states_explored;
+        double seconds;
+        std::vector<std::pair<std::string, long long>> extra_stats;
+    };
+
+    // Written to by every measured operation so the compiler cannot drop the work
+    volatile uint64_t sink = 0;
+
+    // Doubles the batch size until one batch runs for at least min_time, then reports that batch
+    MicroResult measure(const std::string& board, const std::string& name, double min_time, const std::function<uint64_t()>& op) {
+        uint64_t iterations = 1;
+        while (true) {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t local = 0;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                local += op();
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            sink = sink + local;
+            if (elapsed.count() >= min_time || iterations >= (uint64_t(1) << 40)) {
+                return {board, name, iterations, elapsed.count() * 1e9 / static_cast<double>(iterations)};
+            }
+            iterations *= 2;
+        }
+    }
+
+    std::vector<std::string> split(const std::string& text, char separator) {
+        std::vector<std::string> parts;
+        std::istringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator)) {
+            if (!part.empty()) {
+                parts.push_back(part);
+            }
+        }
+        return parts;
+    }
+
+    Options parse_arguments(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--dir") {
+                options.directory = value;
+            } else if (arg == "--format") {
+                options.format = value;
+            } else if (arg == "--out") {
+                options.output = value;
+            } else if (arg == "--min-time") {
+                options.min_time = std::stod(value);
+            } else if (arg == "--algos") {
+                options.algorithms = split(value, ',');
+            } else if (arg == "--heuristic") {
+                options.heuristics = value;
+            } else {
+                throw std::invalid_argument("Unknown argument: " + arg);
+            }
+        }
+        if (argc % 2 == 0) {
+            throw std::invalid_argument("Missing value for " + std::string(argv[argc - 1]));
+        }
+        if (options.format != "json" && options.format != "csv") {
+            throw std::invalid_argument("Unknown format: " + options.format);
+        }
+        return options;
+    }
+
+    std::string json_string(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    void write_json(std::ostream& out, const std::vector<MicroResult>& micro, const std::vector<SolveResult>& solves) {
+        out << "{\n  \"micro\": [\n";
+        for (size_t i = 0; i < micro.size(); ++i) {
+            const auto& r = micro[i];
+            out << "    {\"board\": " << json_string(r.board) << ", \"name\": " << json_string(r.name)
+                << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.ns_per_op << "}"
+                << (i + 1 < micro.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n  \"solve\": [\n";
+        for (size_t i = 0; i < solves.size(); ++i) {
+            const auto& r = solves[i];
+            double rate = r.seconds > 0.0 ? r.states_explored / r.seconds : 0.0;
+            out << "    {\"board\": " << json_string(r.board) << ", \"algorithm\": " << json_string(r.algorithm)
+                << ", \"status\": " << json_string(r.status) << ", \"moves\": " << r.moves
+                << ", \"states_explored\": " << r.states_explored << ", \"seconds\": " << r.seconds
+                << ", \"nodes_per_second\": " << rate << ", \"extra\": {";
+            for (size_t k = 0; k < r.extra_stats.size(); ++k) {
+                out << (k > 0 ? ", " : "") << json_string(r.extra_stats[k].first) << ": " << r.extra_stats[k].second;
+            }
+            out << "}}" << (i + 1 < solves.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    // One table with a kind column so both sections fit a single CSV
+    void write_csv(std::ostream& out, const std::vector<MicroResult>& micro, const std::vector<SolveResult>& solves) {
+        out << "kind,board,name,iterations,ns_per_op,status,moves,states_explored,seconds,nodes_per_second\n";
+        for (const auto& r : micro) {
+            out << "micro," << r.board << ',' << r.name << ',' << r.iterations << ',' << r.ns_per_op << ",,,,,\n";
+        }
+        for (const auto& r : solves) {
+            double rate = r.seconds > 0.0 ? r.states_explored / r.seconds : 0.0;
+            out << "solve," << r.board << ',' << r.algorithm << ",,," << r.status << ',' << r.moves << ','
+                << r.states_explored << ',' << r.seconds << ',' << rate << '\n';
+        }
+    }
+
+    void run_micro(const std::string& name, const Board& board, double min_time, std::vector<MicroResult>& results) {
+        Steps steps(board);
+        Steps other(board);
+        std::vector<Steps> neighbours = steps.get_possible_steps();
+        const Steps& different = neighbours.empty() ? other : neighbours.front();
+        std::shared_ptr<Piece> piece = board.get_pieces().begin()->second;
+        AStar blocked;
+        blocked.set_heuristics("blockedcarheuristic");
+        AStar manhattan;
+        manhattan.set_heuristics("manhattandistance");
+        const PieceTable& table = *steps.get_table();
+        const State& state = steps.get_state();
+
+        results.push_back(measure(name, "Steps::get_possible_steps", min_time, [&] { return steps.get_possible_steps().size(); }));
+        results.push_back(measure(name, "Steps::hash", min_time, [&] { return steps.hash(); }));
+        results.push_back(measure(name, "Steps::operator== (equal)", min_time, [&] { return static_cast<uint64_t>(steps == other); }));
+        results.push_back(measure(name, "Steps::operator== (different)", min_time, [&] { return static_cast<uint64_t>(steps == different); }));
+        results.push_back(measure(name, "Board copy", min_time, [&] { Board copy(board); return copy.get_pieces().size(); }));
+        results.push_back(measure(name, "Board::get_possible_positions", min_time, [&] { return board.get_possible_positions(piece).size(); }));
+        results.push_back(measure(name, "Steps::is_goal", min_time, [&] { return static_cast<uint64_t>(steps.is_goal()); }));
+        results.push_back(measure(name, "blocked_car_heuristic", min_time, [&] { return static_cast<uint64_t>(blocked.heuristic(table, state)); }));
+        results.push_back(measure(name, "manhattan_distance", min_time, [&] { return static_cast<uint64_t>(manhattan.heuristic(table, state)); }));
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<std::string> files;
+    try {
+        options = parse_arguments(argc, argv);
+        for (const auto& entry : std::filesystem::directory_iterator(options.directory)) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path().string());
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << "Usage: rushhour_bench [--dir <puzzles>] [--format json|csv] [--out <file>] [--min-time <seconds>] "
+                  << "[--algos a*,ucs,...] [--heuristic <name>]" << std::endl;
+        return 1;
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<MicroResult> micro;
+    std::vector<SolveResult> solves;
+    for (const auto& file : files) {
+        ProgramModel model;
+        try {
+            model.load_board(file);
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping " << file << ": " << e.what() << std::endl;
+            continue;
+        }
+        std::string name = std::filesystem::path(file).filename().string();
+        std::cerr << "Benchmarking " << name << std::endl;
+        run_micro(name, model.get_initial_board(), options.min_time, micro);
+        for (const auto& algorithm : options.algorithms) {
+            try {
+                Algorithms::Result result = model.run_solver(algorithm, options.heuristics);
+                solves.push_back({name, algorithm, result.path.empty() ? "unsolved" : "solved", result.move_count,
+                                  result.states_explored, result.time_taken, result.extra_stats});
+            } catch (const std::exception& e) {
+                std::cerr << "  " << algorithm << " failed: " << e.what() << std::endl;
+                solves.push_back({name, algorithm, "error", 0, 0, 0.0, {}});
+            }
+        }
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file.is_open()) {
+            std::cerr << "Error: could not open " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if (options.format == "json") {
+        write_json(out, micro, solves);
+    } else {
+        write_csv(out, micro, solves);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "model/Corpus.hpp"
+#include "model/Enumeration.hpp"
+
+// Enumerates every layout up to a piece count, splits them into components and writes the hardest
+// puzzle of each solvable component to a compact binary file (see LayoutEnumerator).
+// Usage: rushhour_enumerate --out file [--max-pieces N] [--rows N] [--cols N] [--threads N]
+
+namespace {
+    struct Options {
+        EnumerationOptions enumeration;
+        std::string output;
+    };
+
+    Options parse_arguments(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--max-pieces") {
+                options.enumeration.max_pieces = std::stoi(value);
+            } else if (arg == "--rows") {
+                options.enumeration.rows = std::stoi(value);
+            } else if (arg == "--cols") {
+                options.enumeration.cols = std::stoi(value);
+            } else if (arg == "--threads") {
+                options.enumeration.threads = std::stoi(value);
+            } else if (arg == "--out") {
+                options.output = value;
+            } else {
+                throw std::invalid_argument("Unknown argument: " + arg);
+            }
+        }
+        if (argc % 2 == 0) {
+            throw std::invalid_argument("Missing value for " + std::string(argv[argc - 1]));
+        }
+        if (options.output.empty()) {
+            throw std::invalid_argument("--out is required");
+        }
+        return options;
+    }
+
+    // Row-major cells in the corpus encoding
+    std::string cells(const LayoutEnumerator::FileHeader& header, const EnumeratedComponent& component) {
+        std::string text(header.rows * header.cols, 'o');
+        for (size_t i = 0; i < component.pieces.size(); ++i) {
+            uint8_t piece = component.pieces[i];
+            int cell = piece & 0x3F;
+            int step = piece & 0x40 ? header.cols : 1;
+            for (int k = 0; k < (piece & 0x80 ? 3 : 2); ++k, cell += step) {
+                text[cell] = i == 0 ? CORPUS_PRIMARY : CORPUS_LABELS[i - 1];
+            }
+        }
+        return text;
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        Options options = parse_arguments(argc, argv);
+        LayoutEnumerator enumerator(options.enumeration);
+        auto start = std::chrono::steady_clock::now();
+        EnumerationSummary summary = enumerator.run(options.output);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cerr << "Lane assignments: " << summary.lane_assignments << "\n"
+                  << "Layouts: " << summary.layouts << "\n"
+                  << "Components: " << summary.components << " (" << summary.solvable_components << " solvable)\n"
+                  << "Hardest puzzle: " << summary.hardest_moves << " moves\n"
+                  << "Time: " << elapsed.count() << " s" << std::endl;
+        // Read the file back and show the first of the hardest puzzles
+        EnumeratedComponent hardest{-1, 0, {}};
+        auto header = LayoutEnumerator::read(options.output, [&](const EnumeratedComponent& component) {
+            if (component.moves > hardest.moves) {
+                hardest = component;
+            }
+        });
+        if (hardest.moves >= 0) {
+            std::cerr << "Example: " << hardest.moves << " " << cells(header, hardest) << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << "Usage: rushhour_enumerate --out <file> [--max-pieces N] [--rows N] [--cols N] [--threads N]" << std::endl;
+        return 1;
+    }
+    return 0;
+}
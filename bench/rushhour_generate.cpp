@@ -0,0 +1,84 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "model/PuzzleGenerator.hpp"
+
+// Writes a corpus of hard puzzles for the solvers to be benchmarked and tuned against.
+// Usage: rushhour_generate [--count N] [--min-moves N] [--min-pieces N] [--max-pieces N] [--seed N]
+//                          [--climb N] [--threads N] [--rows N] [--cols N] [--max-attempts N] [--out file]
+
+namespace {
+    struct Options {
+        GeneratorOptions generator;
+        std::string output;
+    };
+
+    Options parse_arguments(int argc, char** argv) {
+        Options options;
+        GeneratorOptions& generator = options.generator;
+        for (int i = 1; i + 1 < argc; i += 2) {
+            std::string arg = argv[i];
+            std::string value = argv[i + 1];
+            if (arg == "--count") {
+                generator.count = std::stoull(value);
+            } else if (arg == "--min-moves") {
+                generator.min_moves = std::stoi(value);
+            } else if (arg == "--min-pieces") {
+                generator.min_pieces = std::stoi(value);
+            } else if (arg == "--max-pieces") {
+                generator.max_pieces = std::stoi(value);
+            } else if (arg == "--seed") {
+                generator.seed = std::stoull(value);
+            } else if (arg == "--climb") {
+                generator.climb_steps = std::stoi(value);
+            } else if (arg == "--threads") {
+                generator.threads = std::stoi(value);
+            } else if (arg == "--rows") {
+                generator.rows = std::stoi(value);
+            } else if (arg == "--cols") {
+                generator.cols = std::stoi(value);
+            } else if (arg == "--max-attempts") {
+                generator.max_attempts = std::stoull(value);
+            } else if (arg == "--out") {
+                options.output = value;
+            } else {
+                throw std::invalid_argument("Unknown argument: " + arg);
+            }
+        }
+        if (argc % 2 == 0) {
+            throw std::invalid_argument("Missing value for " + std::string(argv[argc - 1]));
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parse_arguments(argc, argv);
+        PuzzleGenerator generator(options.generator);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<GeneratedPuzzle> puzzles = generator.generate();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (options.output.empty()) {
+            generator.write_corpus(std::cout, puzzles);
+        } else {
+            std::ofstream out(options.output);
+            if (!out) {
+                throw std::runtime_error("Could not open output file: " + options.output);
+            }
+            generator.write_corpus(out, puzzles);
+        }
+        std::cerr << "Generated " << puzzles.size() << " puzzles in " << elapsed.count() << " s" << std::endl;
+        if (puzzles.size() < options.generator.count) {
+            std::cerr << "Ran out of attempts; lower --min-moves or raise --max-attempts for more" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        std::cerr << "Usage: rushhour_generate [--count N] [--min-moves N] [--min-pieces N] [--max-pieces N] [--seed N] "
+                  << "[--climb N] [--threads N] [--rows N] [--cols N] [--max-attempts N] [--out <file>]" << std::endl;
+        return 1;
+    }
+    return 0;
+}
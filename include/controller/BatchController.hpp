@@ -0,0 +1,61 @@
+#pragma once
+#include <iostream>
+#include <memory>
+#include <string>
+#include <functional>
+#include <vector>
+#include "model/ProgramModel.hpp"
+#include "view/ProgramView.hpp"
+
+class BatchException : public std::exception {
+private:
+    std::string message;
+public:
+    BatchException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+struct BatchOptions {
+    std::string directory;              // A directory of puzzle files, or a single corpus file (see CorpusReader)
+    std::string algorithm = "a*";
+    std::string heuristics = "blockedcarheuristic";
+    std::string output;
+    int threads = 0;    // 0 means one worker per hardware thread
+    size_t ida_table_megabytes = 16;    // Per-thread limit of the IDA* transposition table, 0 runs without one
+    std::string database;               // Solution database for --algo database, opened once per run
+    std::string cache;                  // File the solution cache persists to, empty for memory only
+    size_t cache_capacity = 0;          // Entries kept by the solution cache, 0 runs without one
+    size_t external_megabytes = 64;     // RAM budget of --algo external
+    std::string external_directory;     // Scratch files of --algo external, empty for the temporary directory
+    size_t beam_width = 1024;           // States kept per layer by --algo beam
+    SearchBudget budget;                // Per-puzzle time, node and memory limits, unlimited by default
+};
+
+struct BatchRow {
+    std::string file;
+    std::string status;
+    int move_count = 0;
+    int states_explored = 0;
+    double time_taken = 0.0;
+    std::string error;
+};
+
+// Non-interactive mode: solves every puzzle file in a directory and writes one CSV row per puzzle
+class BatchController {
+private:
+    std::shared_ptr<ProgramView> view;
+public:
+    BatchController();
+    static bool is_batch_invocation(int argc, char** argv);
+    BatchOptions parse_arguments(int argc, char** argv);
+    static std::vector<std::string> collect_files(const std::string& directory);
+    BatchRow solve_file(const std::string& filepath, const BatchOptions& options, std::shared_ptr<SolutionCache> cache = nullptr,
+                        std::shared_ptr<const SolutionDatabase> database = nullptr);
+    // Solves whatever board load puts into a fresh model; label names the puzzle in its row
+    BatchRow solve_puzzle(const std::string& label, const std::function<void(ProgramModel&)>& load, const BatchOptions& options, std::shared_ptr<SolutionCache> cache = nullptr,
+                          std::shared_ptr<const SolutionDatabase> database = nullptr);
+    void write_csv(std::ostream& out, const std::vector<BatchRow>& rows);
+    int run(int argc, char** argv);
+};
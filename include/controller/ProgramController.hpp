@@ -10,6 +10,7 @@ class ProgramController {
 private:
     std::shared_ptr<ProgramModel> model;
     std::shared_ptr<ProgramView> view;
+    std::shared_ptr<CountingObserver> counter;
 public:
     ProgramController();
     void init();
@@ -17,6 +18,9 @@ public:
     void load();
     void solver();
     void exit();
+    void save_database();
+    void load_database();
     void load_board(const std::string& filepath);
+    void set_observer_mode(const std::string& mode);
     void run_solver(const std::string& algorithm, const std::string& heuristics = "blockedcarheuristic");
 };
\ No newline at end of file
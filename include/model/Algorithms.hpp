@@ -9,8 +9,19 @@
 #include <algorithm>
 #include <chrono>
 #include <stack>
+#include <deque>
+#include <limits>
 #include <thread>
 #include "Board.hpp"
+#include "State.hpp"
+#include "NodeArena.hpp"
+#include "SolverObserver.hpp"
+#include "BucketQueue.hpp"
+#include "SearchStats.hpp"
+#include "SearchBudget.hpp"
+#include "PatternDatabase.hpp"
+#include "SolutionDatabase.hpp"
+#include "ExternalSearch.hpp"
 
 class AlgorithmsException : public std::exception {
 private:
@@ -24,20 +35,21 @@ public:
 
 class Steps {
 private:
-    std::map<std::string, Position> pieces;
-    Board board;
+    std::shared_ptr<const PieceTable> table;
+    State state;
 public:
-    Steps() : board() {}
+    Steps() = default;
     Steps(const Board& board);
-    Steps(const Steps& other);
-    std::map<std::string, Position> get_pieces() const { return pieces; }
-    const Board& get_board() const { return board; }
-    Steps& operator=(const Steps& other);
-    bool operator==(const Steps& other) const;
+    Steps(std::shared_ptr<const PieceTable> table, const State& state) : table(std::move(table)), state(state) {}
+    std::map<std::string, Position> get_pieces() const;
+    Board get_board() const { return table->decode(state); }
+    const State& get_state() const { return state; }
+    const std::shared_ptr<const PieceTable>& get_table() const { return table; }
+    bool operator==(const Steps& other) const { return state == other.state; }
     bool operator!=(const Steps& other) const { return !(*this == other);}
     std::vector<Steps> get_possible_steps() const;
-    size_t hash() const;
-    bool is_goal() const;
+    size_t hash() const { return std::hash<State>{}(state); }
+    bool is_goal() const { return table->is_goal(state); }
     std::string to_string() const;
 };
 
@@ -45,32 +57,75 @@ class Algorithms {
 protected:
     template<typename T>
     struct PQCompare {
-        bool operator()(const std::pair<T, Steps>& a, const std::pair<T, Steps>& b) const {
+        bool operator()(const std::pair<T, uint32_t>& a, const std::pair<T, uint32_t>& b) const {
             return a.first > b.first;
         }
     };
-    static std::vector<Steps> get_path(std::unordered_map<Steps, Steps>& from, Steps& current, Steps& start);
+    static std::vector<Steps> get_path(const std::shared_ptr<const PieceTable>& table, const NodeArena& arena, uint32_t goal);
+    static void report_hash_stats(const PieceTable& table, const NodeArena& arena);
     std::string heuristics;
-    static double manhattan_distance(const Steps& state);
-    static double blocked_car_heuristic(const Steps& state);
+    std::shared_ptr<SolverObserver> observer;
+    std::shared_ptr<const PatternDatabase> pattern_database;
+    SearchBudget budget;
+    // Loads whatever per-puzzle data the current heuristic needs; solvers call it before searching
+    void prepare_heuristic(const PieceTable& table, const State& start);
+    static double manhattan_distance(const PieceTable& table, const State& state);
+    static double blocked_car_heuristic(const PieceTable& table, const State& state);
 public:
-    Algorithms(std::string heuristics = "") : heuristics(heuristics) {};
+    Algorithms(std::string heuristics = "") : heuristics(heuristics), observer(std::make_shared<NullObserver>()) {};
     virtual ~Algorithms() = default;
     void set_heuristics(const std::string& heuristics) { this->heuristics = heuristics; }
-    double heuristic(const Steps& state) const {
+    void set_observer(std::shared_ptr<SolverObserver> observer) {
+        this->observer = observer ? observer : std::make_shared<NullObserver>();
+    }
+    // Every search stops once the budget runs out; DatabaseLookup ignores it
+    void set_budget(const SearchBudget& budget) { this->budget = budget; }
+    // Never negative: blocked_car_heuristic only measures towards an exit on the right, and the open
+    // list cannot key a node below zero
+    double heuristic(const PieceTable& table, const State& state) const {
         if (heuristics == "blockedcarheuristic") {
-            return blocked_car_heuristic(state);
+            return std::max(0.0, blocked_car_heuristic(table, state));
         } else if (heuristics == "manhattandistance") {
-            return manhattan_distance(state);
+            return manhattan_distance(table, state);
+        } else if (heuristics == "patterndatabase") {
+            return pattern_database ? pattern_database->lookup(state) : 0.0;
+        }
+        return 0.0;
+    }
+    // How far the primary car still is from the exit; picks the best state of an interrupted search
+    static int progress(const PieceTable& table, const State& state) { return static_cast<int>(manhattan_distance(table, state)); }
+    // Smallest factor that turns every value of the current heuristic into a whole number, for the
+    // open list's buckets. blocked_car_heuristic moves in half steps, the others in whole steps; a new
+    // heuristic has to be added here.
+    int heuristic_scale() const {
+        if (heuristics == "blockedcarheuristic") {
+            return 2;
         }
+        return 1;
     }
     struct Result {
         std::vector<Steps> path;
-        int move_count;
-        int states_explored;
-        double time_taken;
+        int move_count = 0;
+        int states_explored = 0;
+        double time_taken = 0.0;
+        std::vector<std::pair<std::string, long long>> extra_stats;    // Solver-specific counters, shown after the basics
+        SolveStatus status = SolveStatus::FINISHED;
+        // Only when the budget stopped the search: the route to the reached state whose primary car is
+        // closest to the exit. path then stays empty unless an anytime solver already had a solution.
+        std::vector<Steps> partial_path;
+
+        Result() = default;
+        Result(std::vector<Steps> path, int move_count, int states_explored, double time_taken,
+               std::vector<std::pair<std::string, long long>> extra_stats = {})
+            : path(std::move(path)), move_count(move_count), states_explored(states_explored), time_taken(time_taken),
+              extra_stats(std::move(extra_stats)) {}
     };
     virtual Result solve(const Board& board) = 0;
+protected:
+    // Appends the detailed counters, which only RUSHHOUR_SEARCH_STATS builds collect, to a finished result
+    static Result finish(Result result, const SearchStats& stats);
+    // Marks a result as cut short by the guard and fills its partial path from the search tree
+    static Result interrupted(Result result, const BudgetGuard& guard, const std::shared_ptr<const PieceTable>& table, const NodeArena& arena);
 };
 
 class AStar : public Algorithms {
@@ -79,7 +134,14 @@ public:
     Result solve(const Board& board) override;
 };
 
+// The frontier holds packed 64 or 128-bit keys with g and h instead of arena nodes, so only expanded
+// states take a full State; boards whose layout needs more bits fall back to the arena for both
 class GBFS : public Algorithms {
+private:
+    using Clock = std::chrono::high_resolution_clock;
+    template<int WORDS>
+    Result solve_packed(const std::shared_ptr<const PieceTable>& table, const State& start, const StateCodec& codec, BudgetGuard& guard, Clock::time_point start_time);
+    Result solve_with_arena(const std::shared_ptr<const PieceTable>& table, const State& start, BudgetGuard& guard, Clock::time_point start_time);
 public:
     GBFS() = default;
     Result solve(const Board& board) override;
@@ -91,8 +153,88 @@ public:
     Result solve(const Board& board) override;
 };
 
+// Anytime repairing A* (ARA*): finds a first solution quickly with the heuristic inflated by
+// initial_weight, then lowers the weight by weight_step and repairs the same search tree instead of
+// starting over, until the weight reaches 1 or the budget runs out. Every improvement is reported to
+// the observer with its suboptimality bound, which holds when the heuristic is admissible.
+class AnytimeAStar : public Algorithms {
+private:
+    double initial_weight;
+    double weight_step;
+public:
+    AnytimeAStar(double initial_weight = 3.0, double weight_step = 0.5) : initial_weight(initial_weight), weight_step(weight_step) {}
+    Result solve(const Board& board) override;
+};
+
+// Recursive depth-first IDA*: memory is O(depth) plus an optional transposition table that grows up
+// to table_megabytes
 class IDA : public Algorithms {
+private:
+    size_t table_megabytes;
+public:
+    IDA(size_t table_megabytes = 0) : table_megabytes(table_megabytes) {}
+    Result solve(const Board& board) override;
+};
+
+// Hash-distributed A*: every state is owned by the worker picked by its hash, and workers exchange
+// generated states through lock-free mailboxes. Optimal whenever the heuristic is admissible.
+class HDAStar : public Algorithms {
+private:
+    int threads;
+public:
+    HDAStar(int threads = 0) : threads(threads) {}
+    Result solve(const Board& board) override;
+};
+
+// Breadth-first search from the start and, at the same time, backwards from every goal layout that
+// keeps the start's lane order, expanding whichever frontier is smaller one full layer at a time.
+// Moves are reversible, so both directions share get_moves. Falls back to plain forward BFS when
+// there are too many goal layouts.
+class BidirectionalBFS : public Algorithms {
+private:
+    size_t goal_limit;
+public:
+    BidirectionalBFS(size_t goal_limit = 1 << 18) : goal_limit(goal_limit) {}
+    Result solve(const Board& board) override;
+};
+
+// Breadth-first search for state spaces larger than RAM: layers are kept as sorted files of packed
+// states and duplicates are removed by merging against them, so only the successor buffer of at most
+// memory_megabytes is ever held in memory
+class ExternalBFS : public Algorithms {
+private:
+    size_t memory_megabytes;
+    std::string directory;      // Parent of the scratch files, empty for the system temporary directory
+public:
+    ExternalBFS(size_t memory_megabytes = 64, std::string directory = "") : memory_megabytes(memory_megabytes), directory(std::move(directory)) {}
+    Result solve(const Board& board) override;
+};
+
+// Breadth-first layers pruned to the width states with the lowest heuristic, for boards too large to
+// search exhaustively. Only the parent links of each layer are kept, so memory grows with width times
+// depth. Incomplete: an empty beam or max_depth layers end the search without a solution.
+class BeamSearch : public Algorithms {
+private:
+    size_t width;
+    size_t max_depth;
+public:
+    BeamSearch(size_t width = 1024, size_t max_depth = 4096) : width(width), max_depth(max_depth) {}
+    Result solve(const Board& board) override;
+};
+
+// Enumerates the start's whole reachable component and labels every state with its exact distance
+// to the nearest goal (see RetrogradeAnalysis), then reads an optimal path straight off the table
+class Retrograde : public Algorithms {
+public:
+    Retrograde() = default;
+    Result solve(const Board& board) override;
+};
+
+// Answers from a precomputed SolutionDatabase instead of searching: every step is one table lookup
+class DatabaseLookup : public Algorithms {
+private:
+    std::shared_ptr<const SolutionDatabase> database;
 public:
-    IDA() = default;
+    DatabaseLookup(std::shared_ptr<const SolutionDatabase> database) : database(std::move(database)) {}
     Result solve(const Board& board) override;
 };
\ No newline at end of file
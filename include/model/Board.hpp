@@ -32,7 +32,7 @@ private:
     bool is_goal;
 public:
     Cell(int x, int y, const std::shared_ptr<Piece> piece) :position(Position(x, y)), piece(piece) {}
-    std::shared_ptr<Piece> get_piece() const { return piece; }
+    const std::shared_ptr<Piece>& get_piece() const { return piece; }
     bool operator==(const Cell& other) const {
         return position == other.position && piece == other.piece;
     }
@@ -46,6 +46,12 @@ public:
     bool get_is_goal() { return is_goal; }
 };
 
+struct BoardMove {
+    std::shared_ptr<Piece> piece;
+    Position from;
+    Position to;
+};
+
 class Board : public std::enable_shared_from_this<Board> {
 private:
     int rows;
@@ -53,8 +59,8 @@ private:
     std::vector<std::vector<std::unique_ptr<Cell>>> grid;
     Position goal_pos;
     std::map<std::string, std::shared_ptr<Piece>> pieces;
-    void update_cell(std::shared_ptr<Piece> piece);
-    void clear_cell(std::shared_ptr<Piece> piece);
+    void update_cell(const std::shared_ptr<Piece>& piece);
+    void clear_cell(const std::shared_ptr<Piece>& piece);
 public:
     Board() = default;
     Board(int rows, int cols, Position goal_pos = {0,0});
@@ -67,6 +73,9 @@ public:
     void add_piece(const std::shared_ptr<Piece>& piece);
     void remove_piece(const std::shared_ptr<Piece>& piece);
     void move_piece(std::string piece_id, Position new_head);
+    bool can_move_piece(const std::shared_ptr<Piece>& piece, Position new_head) const noexcept;
+    BoardMove apply_move(const std::shared_ptr<Piece>& piece, Position new_head);
+    void undo_move(const BoardMove& move);
     bool is_valid_pos(Position pos) const;
     bool is_valid_piece(std::shared_ptr<Piece> piece, Position new_head) const;
     Cell& get_cell(Position pos) const;
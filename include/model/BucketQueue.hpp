@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+// Priority queue over small non-negative integer keys: one bucket per f, split by h so that among
+// equal f the node closest to the goal comes out first. Push and pop are O(1) amortised while f
+// does not jump far below the current minimum.
+class BucketQueue {
+private:
+    struct FBucket {
+        std::vector<std::vector<uint32_t>> by_h;
+        size_t count = 0;
+        size_t min_h = 0;
+    };
+    std::vector<FBucket> buckets;
+    size_t min_f = 0;
+    size_t count = 0;
+public:
+    void push(size_t f, size_t h, uint32_t handle);
+    uint32_t pop();
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    void clear();
+};
+
+class OpenListException : public std::exception {
+private:
+    std::string message;
+public:
+    OpenListException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+// Open list of node handles for the best-first solvers. Every f and h times scale must be a whole
+// number (see Algorithms::heuristic_scale), so the keys index a BucketQueue directly; push throws
+// OpenListException for a negative or fractional key.
+class OpenList {
+private:
+    int scale;
+    BucketQueue buckets;
+public:
+    OpenList(int scale) : scale(scale) {}
+    void push(double f, double h, uint32_t handle);
+    uint32_t pop() { return buckets.pop(); }
+    bool empty() const { return buckets.empty(); }
+    size_t size() const { return buckets.size(); }
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "Board.hpp"
+
+class CorpusException : public std::exception {
+private:
+    std::string message;
+public:
+    CorpusException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+// Piece letters that survive a round trip through the corpus encoding. Writers give the primary car
+// CORPUS_PRIMARY and the secondaries CORPUS_LABELS in order, which leaves out 'P' (read back as the
+// primary), 'o' (empty) and 'x' (wall).
+constexpr char CORPUS_PRIMARY = 'A';
+constexpr std::string_view CORPUS_LABELS = "BCDEFGHIJKLMNOQRSTUVWXYZabcdefghijklmnpqrstuvwyz";
+
+// One line of a corpus. cells points into the mapped file and is valid while its CorpusReader lives.
+struct CorpusPuzzle {
+    size_t line = 0;            // 1-based line number in the file
+    std::string_view cells;     // rows * cols characters, row-major; empty if the line had none
+    int moves = -1;             // Move count given before the cells, -1 when the line has none
+};
+
+// Many puzzles in one text file, one per line, in the row-major encoding of the public Rush Hour
+// databases:
+//   6 6 A                                    header: rows, cols and the primary car's letter (default A)
+//   51 GBBoLoGHIoLMGHIAAMCCCKoMooJKDDEEJFFo 1  optional move count, the cells, then anything
+// Cells are '.' or 'o' when empty and a letter per piece. The primary car exits through the right
+// edge when horizontal and the bottom edge when vertical. 'x' walls cannot be represented and make
+// that puzzle fail to build. Blank lines and lines starting with '#' are skipped.
+//
+// The file is mapped read-only and scanned in place: next() only finds the fields of the next line,
+// and make_board() builds a Board from its cells in a single pass.
+class CorpusReader {
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t position = 0;
+    size_t line = 0;
+    int rows = 0;
+    int cols = 0;
+    char primary = CORPUS_PRIMARY;
+    std::string path;
+    bool next_line(std::string_view& text);
+public:
+    CorpusReader(const std::string& path);
+    ~CorpusReader();
+    CorpusReader(const CorpusReader&) = delete;
+    CorpusReader& operator=(const CorpusReader&) = delete;
+    // False at the end of the file. A line without a field of rows * cols cells still comes back,
+    // with empty cells, so that make_board reports it against its line.
+    bool next(CorpusPuzzle& puzzle);
+    // Throws CorpusException for malformed cells, walls and pieces that are not straight lines
+    Board make_board(const CorpusPuzzle& puzzle) const;
+    int get_rows() const { return rows; }
+    int get_cols() const { return cols; }
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "Board.hpp"
+
+class EnumerationException : public std::exception {
+private:
+    std::string message;
+public:
+    EnumerationException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+struct EnumerationOptions {
+    int rows = 6;
+    int cols = 6;
+    int max_pieces = 6;     // Including the primary car
+    int threads = 0;        // 0 means one worker per hardware thread
+};
+
+struct EnumerationSummary {
+    uint64_t lane_assignments = 0;      // Assignments with at least one legal layout
+    uint64_t layouts = 0;
+    uint64_t components = 0;
+    uint64_t solvable_components = 0;   // One record each in the file
+    int hardest_moves = -1;
+};
+
+// The hardest puzzle of one solvable component. Each piece is one byte, primary car first: the head's
+// cell index (row * cols + col) in the low six bits, 0x40 when vertical and 0x80 for a truck.
+struct EnumeratedComponent {
+    int moves;
+    uint32_t size;                  // Layouts in the component
+    std::vector<uint8_t> pieces;
+};
+
+// Every legal layout of a board with at most max_pieces pieces, split into connected components.
+// A horizontal two-cell primary car sits in the exit row, which exits on the right as in the
+// generated corpora, and the other pieces are two-cell cars and three-cell trucks. Pieces may share
+// the exit row with the primary car; those to its right leave the whole component unsolvable.
+//
+// Moves never change which pieces share a lane or their order within it, so every component lies
+// inside one lane assignment: the sequence of piece lengths in each row and column. Assignments are
+// enumerated, each one's layouts are listed and packed, and the components are found by BFS over
+// them, followed by a backward BFS from each component's goals. Assignments that are mirror images
+// of one already enumerated are skipped when the board is symmetric about the exit row.
+//
+// Work is split by the contents of the rows and handed to threads through run_work_queue. Records
+// are written in that order, so the output does not depend on the thread count.
+//
+// File layout (version 1, native byte order, checked through byte_order):
+//   FileHeader
+//   per solvable component: uint16_t moves, uint32_t size, uint8_t piece_count, uint8_t pieces[piece_count]
+class LayoutEnumerator {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint8_t rows;
+        uint8_t cols;
+        uint8_t exit_row;
+        uint8_t max_pieces;
+        uint32_t reserved;
+        uint64_t layout_count;
+        uint64_t component_count;   // Solvable components, one record each
+    };
+private:
+    EnumerationOptions options;
+    int exit_row;
+public:
+    LayoutEnumerator(const EnumerationOptions& options);
+    EnumerationSummary run(const std::string& path) const;
+    // Calls visit for every record of a file written by run and returns its header
+    static FileHeader read(const std::string& path, const std::function<void(const EnumeratedComponent&)>& visit);
+    static Board make_board(const FileHeader& header, const EnumeratedComponent& component);
+};
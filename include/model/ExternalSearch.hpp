@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "State.hpp"
+
+class ExternalSearchException : public std::exception {
+private:
+    std::string message;
+public:
+    ExternalSearchException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
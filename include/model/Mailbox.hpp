@@ -0,0 +1,48 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Lock-free multi-producer single-consumer mailbox. Producers push whole batches with a CAS on the
+// list head; the owning thread takes everything at once with a single exchange.
+template<typename T>
+class Mailbox {
+private:
+    struct Batch {
+        std::vector<T> items;
+        Batch* next;
+    };
+    std::atomic<Batch*> head{nullptr};
+public:
+    Mailbox() = default;
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+    ~Mailbox() {
+        Batch* batch = head.load();
+        while (batch) {
+            Batch* next = batch->next;
+            delete batch;
+            batch = next;
+        }
+    }
+    void push(std::vector<T>&& items) {
+        Batch* batch = new Batch{std::move(items), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+    // Appends every pending item to out, oldest batch first, and returns how many were taken
+    size_t drain(std::vector<T>& out) {
+        Batch* batch = head.exchange(nullptr, std::memory_order_acquire);
+        std::vector<Batch*> batches;
+        for (; batch; batch = batch->next) {
+            batches.push_back(batch);
+        }
+        size_t taken = 0;
+        for (auto it = batches.rbegin(); it != batches.rend(); ++it) {
+            taken += (*it)->items.size();
+            std::move((*it)->items.begin(), (*it)->items.end(), std::back_inserter(out));
+            delete *it;
+        }
+        return taken;
+    }
+};
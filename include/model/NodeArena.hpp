@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "State.hpp"
+
+constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+struct Node {
+    State state;
+    uint32_t parent;
+    Move move;          // The move that turned the parent into this state
+    bool closed;
+    double g;
+};
+
+// Contiguous storage for every state a search has reached. Nodes refer to their parent by index,
+// and the deduplication index maps a state's hash to the indices holding it, so each state is kept
+// exactly once and can be looked up without a node of its own.
+class NodeArena {
+private:
+    std::vector<Node> nodes;
+    std::unordered_multimap<size_t, uint32_t> index;
+    uint32_t lookup(const State& state, size_t hash) const;
+public:
+    NodeArena() = default;
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+    std::pair<uint32_t, bool> insert(const State& state, uint32_t parent, const Move& move, double g);
+    uint32_t find(const State& state) const;
+    Node& operator[](uint32_t i) { return nodes[i]; }
+    const Node& operator[](uint32_t i) const { return nodes[i]; }
+    uint32_t size() const { return static_cast<uint32_t>(nodes.size()); }
+    // Approximate heap bytes held by the nodes and the deduplication index
+    size_t memory_usage() const;
+    void clear();
+    std::vector<uint32_t> trace(uint32_t goal) const;
+    HashStats bucket_stats(const std::function<size_t(const State&)>& hasher) const;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "State.hpp"
+
+// Exact goal distances for abstractions of the board that keep only the primary car, the cars
+// sharing its lane and the cars crossing the lane between it and the goal. Every other car is
+// removed, which only makes the puzzle easier, so the distances never overestimate.
+//
+// When one abstraction would be too large the crossing cars are split into groups. Each group's
+// table counts only the moves of its own cars (the first group also owns the primary lane), so the
+// group distances can be added together and stay admissible.
+class PatternDatabase {
+private:
+    struct Pattern {
+        std::vector<int> pieces;        // PieceTable indices kept in this abstraction
+        std::vector<bool> counted;      // Whether moving pieces[k] costs a move in this table
+        std::vector<uint32_t> strides;  // Mixed radix rank: sum of offset * stride
+        std::vector<uint8_t> distances;
+    };
+    std::vector<Pattern> patterns;
+    size_t entries = 0;
+
+    static std::map<std::string, std::shared_ptr<const PatternDatabase>> cache;
+    static std::mutex cache_mutex;
+
+    PatternDatabase(const PieceTable& table, const State& start);
+    static std::string signature(const PieceTable& table, const std::vector<int>& pieces);
+    static std::vector<int> lane_pieces(const PieceTable& table, const State& start, std::vector<int>& crossing);
+    static void build(const PieceTable& table, Pattern& pattern);
+public:
+    static constexpr uint8_t UNREACHABLE = 0xFF;
+    static constexpr size_t MAX_ENTRIES = size_t(1) << 22;     // Per pattern, one byte each
+
+    // Built on first use for each distinct lane geometry and shared afterwards
+    static std::shared_ptr<const PatternDatabase> load(const PieceTable& table, const State& start);
+    double lookup(const State& state) const {
+        int total = 0;
+        for (const auto& pattern : patterns) {
+            uint32_t rank = 0;
+            for (size_t k = 0; k < pattern.pieces.size(); ++k) {
+                rank += state.offsets[pattern.pieces[k]] * pattern.strides[k];
+            }
+            uint8_t distance = pattern.distances[rank];
+            if (distance == UNREACHABLE) {
+                // The goal cannot be reached from here at all
+                return UNREACHABLE;
+            }
+            total += distance;
+        }
+        return total;
+    }
+    size_t pattern_count() const { return patterns.size(); }
+    size_t size() const { return entries; }
+};
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -29,7 +30,7 @@ public:
     std::string get_id() const { return id; }
     int get_length() const { return length; }
     Orientation get_orientation() const { return orientation; }
-    std::vector<Position> get_positions() const { return positions;}
+    const std::vector<Position>& get_positions() const { return positions;}
     Color get_color() const { return color; }
     Position get_head() const { return head; }
     void move(Position newHead);
@@ -42,7 +43,7 @@ public:
 
 class Secondary : public Piece {
 private:
-    static int counter;
+    static std::atomic<int> counter;
 public:
     Secondary(std::string id, int length, const Position& pos, const Orientation& orientation);
 };
\ No newline at end of file
@@ -1,17 +1,50 @@
 #pragma once
+#include <functional>
 #include <memory>
 #include "model/Algorithms.hpp"
 #include "model/Board.hpp"
 #include "model/Reader.hpp"
+#include "model/SolutionCache.hpp"
 
 class ProgramModel {
 private:
     Board initial_board;
-    std::map<std::string, std::shared_ptr<Algorithms>> algorithms;
+    // Factories rather than shared instances: every run_solver call gets its own solver state
+    std::map<std::string, std::function<std::shared_ptr<Algorithms>()>> algorithms;
+    std::shared_ptr<SolverObserver> observer;
+    size_t ida_table_megabytes = 16;
+    size_t external_memory_megabytes = 64;
+    size_t beam_width = 1024;
+    std::string external_directory;
+    std::shared_ptr<const SolutionDatabase> solution_database;
+    std::shared_ptr<Algorithms> make_database_lookup() const;
+    std::shared_ptr<SolutionCache> solution_cache;
+    std::string solver_parameters() const;
 public:
     ProgramModel();
     void init();
     void create_board(int rows, int cols, int sec_count, std::vector<std::string> board_config);
+    void load_board(const std::string& filepath);
+    void set_initial_board(const Board& board) { initial_board = board; }
     Board get_initial_board() const { return initial_board; }
-    Algorithms::Result run_solver(const std::string& algorithm, const std::string& heuristics = "blockedcarheuristic");
+    void set_observer(std::shared_ptr<SolverObserver> observer) { this->observer = observer; }
+    void set_ida_table_megabytes(size_t megabytes) { ida_table_megabytes = megabytes; }
+    // RAM budget and scratch directory of the external-memory BFS
+    void set_external_memory(size_t megabytes, const std::string& directory) {
+        external_memory_megabytes = megabytes;
+        external_directory = directory;
+    }
+    void set_beam_width(size_t width) { beam_width = width; }
+    // Runs a full retrograde analysis of the loaded board and stores it for the "database" solver
+    void save_solution_database(const std::string& filepath) const;
+    void load_solution_database(const std::string& filepath);
+    // Shares an already opened database, so several models map the file once
+    void set_solution_database(std::shared_ptr<const SolutionDatabase> database) { solution_database = database; }
+    bool has_solution_database() const { return solution_database != nullptr; }
+    // None by default, so run_solver always searches; the same cache may be shared by several models
+    void set_solution_cache(std::shared_ptr<SolutionCache> cache) { solution_cache = cache; }
+    std::shared_ptr<SolutionCache> get_solution_cache() const { return solution_cache; }
+    // A limited budget may stop the solver early (see Result::status); such results depend on timing
+    // and are never cached
+    Algorithms::Result run_solver(const std::string& algorithm, const std::string& heuristics = "blockedcarheuristic", const SearchBudget& budget = {}) const;
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class GeneratorException : public std::exception {
+private:
+    std::string message;
+public:
+    GeneratorException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+struct GeneratorOptions {
+    int rows = 6;
+    int cols = 6;
+    size_t count = 1000;            // Puzzles to emit
+    int min_moves = 20;             // Shortest optimal solution accepted
+    int min_pieces = 10;            // Piece counts include the primary car
+    int max_pieces = 14;
+    uint64_t seed = 1;
+    int climb_steps = 100;          // Changes tried on each random layout to make it harder
+    int threads = 0;                // 0 means one worker per hardware thread
+    uint64_t max_attempts = 0;      // Random layouts tried before giving up, 0 for 100 per puzzle
+    size_t max_component_states = size_t(1) << 22;    // Larger components are skipped
+};
+
+struct GeneratedPuzzle {
+    uint64_t attempt;               // Index of the layout it came from, which reproduces it
+    int moves;
+    int pieces;
+    uint64_t component_size;
+    std::string cells;              // Row-major, in the corpus encoding (see CorpusReader)
+};
+
+// Builds hard puzzles backwards: every attempt places random pieces around a primary car already at
+// the exit, sweeps the component of that solved layout and runs a backward BFS from all of its goals,
+// as RetrogradeAnalysis does but over a hash-indexed component instead of a table of every layout.
+// The deepest state found is the hardest puzzle of the component. The layout is then hill-climbed:
+// random changes to its secondaries are kept whenever they do not make that puzzle easier.
+//
+// Attempt i draws from its own generator seeded with (seed, i), and accepted puzzles are kept in
+// attempt order with duplicates dropped, so the output depends on the seed but not on the threads.
+class PuzzleGenerator {
+private:
+    GeneratorOptions options;
+    int exit_row;
+public:
+    PuzzleGenerator(const GeneratorOptions& options);
+    // False when attempt i gives no acceptable puzzle
+    bool attempt(uint64_t index, GeneratedPuzzle& puzzle) const;
+    // Stops at options.count puzzles or after options.max_attempts layouts, whichever comes first
+    std::vector<GeneratedPuzzle> generate() const;
+    // A corpus file CorpusReader reads back: the header, then "moves cells component_size" per line
+    void write_corpus(std::ostream& out, const std::vector<GeneratedPuzzle>& puzzles) const;
+};
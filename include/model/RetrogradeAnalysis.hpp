@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SearchBudget.hpp"
+#include "State.hpp"
+#include "SolverObserver.hpp"
+
+class RetrogradeException : public std::exception {
+private:
+    std::string message;
+public:
+    RetrogradeException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+// Perfect rank of every layout that keeps the start's order of the pieces sharing each lane. A lane
+// holding k pieces in m = lane_size - sum(length - 1) slots is a k-subset of m, ranked with the
+// combinatorial number system, and the lanes are combined as mixed radix digits.
+class StateRanker {
+private:
+    struct Lane {
+        std::vector<int> pieces;    // In lane order
+        int slots;
+        uint64_t count;
+        uint64_t stride;
+    };
+    const PieceTable* table;
+    std::vector<Lane> lanes;
+    std::vector<std::vector<uint64_t>> binomial;
+    uint64_t total = 1;
+    uint64_t choose(int n, int k) const { return k > n ? 0 : binomial[n][k]; }
+public:
+    StateRanker(const PieceTable& table, const State& start);
+    // lane_order[i] is piece i's position among the pieces of its lane, as lane_order() returns it
+    StateRanker(const PieceTable& table, const std::vector<int>& lane_order);
+    uint64_t size() const { return total; }
+    std::vector<int> lane_order() const;
+    // False when the state breaks the lane order and so has no rank
+    bool rank(const State& state, uint64_t& result) const;
+    State unrank(uint64_t rank) const;
+};
+
+// Every state reachable from a start layout together with its exact distance to the nearest goal,
+// found by a forward sweep over the component followed by a backward BFS from all of its goals.
+class RetrogradeAnalysis {
+private:
+    std::shared_ptr<const PieceTable> table;
+    StateRanker ranker;
+    std::vector<uint16_t> distances;
+    uint64_t component_size = 0;
+    uint64_t solvable_states = 0;
+    int hardest_distance = -1;
+    State hardest_state;
+public:
+    static constexpr uint16_t OUTSIDE = 0xFFFF;         // Not reachable from the start
+    static constexpr uint16_t UNSOLVABLE = 0xFFFE;      // Reachable, but no goal is
+    static constexpr uint64_t MAX_RANKS = uint64_t(1) << 27;
+
+    // A guard that stops the sweeps leaves the distances incomplete, so the analysis must not be queried
+    RetrogradeAnalysis(std::shared_ptr<const PieceTable> table, const State& start, SolverObserver* observer = nullptr,
+                       BudgetGuard* guard = nullptr);
+    // Moves to the nearest goal, or -1 for states outside the component or cut off from every goal
+    int distance(const State& state) const;
+    // An optimal path to a goal, found by always stepping to a successor one move closer
+    std::vector<State> solution(const State& state) const;
+    uint64_t get_component_size() const { return component_size; }
+    uint64_t get_solvable_states() const { return solvable_states; }
+    int get_hardest_distance() const { return hardest_distance; }
+    const State& get_hardest_state() const { return hardest_state; }
+    uint64_t get_table_size() const { return distances.size(); }
+    const std::shared_ptr<const PieceTable>& get_table() const { return table; }
+    const StateRanker& get_ranker() const { return ranker; }
+    const std::vector<uint16_t>& get_distances() const { return distances; }
+};
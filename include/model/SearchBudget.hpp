@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Set from any thread to ask a running solve to stop at its next budget check
+class CancellationToken {
+private:
+    std::atomic<bool> cancelled{false};
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool is_cancelled() const { return cancelled.load(std::memory_order_relaxed); }
+};
+
+// Limits after which a solver stops and returns what it has so far; zero means unlimited
+struct SearchBudget {
+    double seconds = 0.0;           // Wall-clock time from the start of solve
+    uint64_t nodes = 0;             // States expanded
+    size_t memory_megabytes = 0;    // Held by the search's node storage and open list
+    std::shared_ptr<const CancellationToken> cancellation;
+    bool unlimited() const { return seconds <= 0.0 && nodes == 0 && memory_megabytes == 0 && !cancellation; }
+};
+
+enum class SolveStatus {
+    FINISHED,           // The search ran to completion, with or without a solution
+    BUDGET_EXCEEDED,    // Stopped by the time, node or memory limit
+    CANCELLED,          // Stopped through the cancellation token
+};
+
+// Checks a SearchBudget from a solver's inner loop. The node count is compared on every call, the clock,
+// the memory estimate and the token only every CHECK_INTERVAL calls so that the check stays cheap.
+class BudgetGuard {
+private:
+    static constexpr uint32_t CHECK_INTERVAL = 256;
+    SearchBudget budget;
+    std::chrono::steady_clock::time_point deadline;
+    uint32_t calls = 0;
+    SolveStatus status = SolveStatus::FINISHED;
+    void check(size_t memory_bytes);
+public:
+    // The time limit runs from start. Solvers build their guard first thing in solve so that setup
+    // such as pattern database construction counts against it.
+    BudgetGuard(const SearchBudget& budget, std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now());
+    // True once the search has to stop. memory is only called on the periodic checks and returns the
+    // bytes the search holds now.
+    template<typename F>
+    bool exceeded(uint64_t expanded, F&& memory) {
+        if (status != SolveStatus::FINISHED) {
+            return true;
+        }
+        if (budget.nodes > 0 && expanded >= budget.nodes) {
+            status = SolveStatus::BUDGET_EXCEEDED;
+        } else if (++calls % CHECK_INTERVAL == 0) {
+            check(budget.memory_megabytes > 0 ? memory() : 0);
+        }
+        return status != SolveStatus::FINISHED;
+    }
+    // Lets the parallel solver stop every worker once one of them ran out
+    void stop(SolveStatus reason) { status = reason; }
+    SolveStatus get_status() const { return status; }
+    bool stopped() const { return status != SolveStatus::FINISHED; }
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Detailed search counters and phase timers. They are only compiled in with RUSHHOUR_SEARCH_STATS;
+// otherwise every member is an empty inline function and the solvers' calls compile away.
+class SearchStats {
+public:
+    enum Phase { EXPANSION, HASHING, HEURISTIC, QUEUE, PHASE_COUNT };
+#ifdef RUSHHOUR_SEARCH_STATS
+private:
+    uint64_t generated_nodes = 0;
+    uint64_t duplicates = 0;
+    uint64_t reopenings = 0;
+    uint64_t open_updates = 0;
+    size_t open_peak = 0;
+    size_t closed_nodes = 0;
+    size_t closed_peak = 0;
+    size_t memory_bytes = 0;
+    size_t memory_states = 0;
+    double seconds[PHASE_COUNT] = {};
+public:
+    static constexpr bool enabled = true;
+    // Runs f and charges its wall time to phase
+    template<typename F>
+    auto timed(Phase phase, F&& f) {
+        struct Charge {
+            double& total;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            ~Charge() { total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); }
+        } charge{seconds[phase]};
+        return f();
+    }
+    void generated(size_t count) { generated_nodes += count; }
+    void duplicate() { duplicates++; }
+    void closed() {
+        closed_nodes++;
+        closed_peak = std::max(closed_peak, closed_nodes);
+    }
+    // An expanded node reached by a cheaper path goes back onto the open list
+    void reopened() {
+        reopenings++;
+        closed_nodes--;
+    }
+    // A node still on the open list reached by a better path is pushed again
+    void updated() { open_updates++; }
+    void open_size(size_t size) { open_peak = std::max(open_peak, size); }
+    void memory(size_t bytes, size_t states) {
+        memory_bytes += bytes;
+        memory_states += states;
+    }
+    // Adds another worker's counters; peaks are summed, an upper bound on the combined peak
+    void merge(const SearchStats& other);
+    void append_to(std::vector<std::pair<std::string, long long>>& extra_stats) const;
+#else
+public:
+    static constexpr bool enabled = false;
+    template<typename F>
+    auto timed(Phase, F&& f) { return f(); }
+    void generated(size_t) {}
+    void duplicate() {}
+    void closed() {}
+    void reopened() {}
+    void updated() {}
+    void open_size(size_t) {}
+    void memory(size_t, size_t) {}
+    void merge(const SearchStats&) {}
+    void append_to(std::vector<std::pair<std::string, long long>>&) const {}
+#endif
+    // Highest resident set size of this process so far, in kilobytes; 0 where unsupported
+    static long long peak_rss_kb();
+};
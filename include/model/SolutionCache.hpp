@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Board.hpp"
+#include "State.hpp"
+
+class SolutionCacheException : public std::exception {
+private:
+    std::string message;
+public:
+    SolutionCacheException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+// Bounded least-recently-used store of finished solves, keyed by a canonical encoding of the start
+// board plus the algorithm, heuristic and solver parameters. Only the moves and statistics are kept,
+// so a hit replays the moves instead of searching. Safe to share between threads. Inserts stay in
+// memory; a cache with a file is written back only when save is called.
+class SolutionCache {
+public:
+    struct Entry {
+        std::string key;
+        std::vector<Move> moves;
+        bool solved = false;
+        int states_explored = 0;
+        double time_taken = 0.0;
+        std::vector<std::pair<std::string, long long>> extra_stats;
+    };
+private:
+    size_t capacity;
+    std::string filepath;   // Empty keeps the cache in memory only
+    std::list<Entry> entries;   // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    mutable std::mutex mutex;
+    void load();
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64;
+
+    SolutionCache(size_t capacity = DEFAULT_CAPACITY, const std::string& filepath = "");
+    // parameters holds every solver setting that can change the result, such as the beam width
+    static std::string make_key(const Board& board, const std::string& algorithm, const std::string& heuristics,
+                                const std::string& parameters);
+    // Copies the entry out and marks it most recently used; counts a hit or a miss
+    bool find(const std::string& key, Entry& entry);
+    void insert(Entry entry);
+    // Drops an entry that find returned but that turned out to be unusable; that lookup counts as a miss
+    void evict(const std::string& key);
+    // Rewrites the file with the current entries; a no-op for an in-memory cache
+    void save() const;
+    uint64_t get_hits() const { std::lock_guard<std::mutex> lock(mutex); return hits; }
+    uint64_t get_misses() const { std::lock_guard<std::mutex> lock(mutex); return misses; }
+    size_t size() const { std::lock_guard<std::mutex> lock(mutex); return entries.size(); }
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RetrogradeAnalysis.hpp"
+#include "State.hpp"
+
+class SolutionDatabaseException : public std::exception {
+private:
+    std::string message;
+public:
+    SolutionDatabaseException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+// On-disk goal distances for one puzzle's component, as produced by RetrogradeAnalysis. The file is
+// mapped read-only and queried in place, so processes opening the same file share one copy through
+// the page cache.
+//
+// Layout (version 1, native byte order, checked through byte_order):
+//   FileHeader
+//   PieceRecord[piece_count], in PieceTable order
+//   padding up to distances_offset (8-byte aligned)
+//   uint16_t distances[rank_count], indexed by StateRanker rank (0xFFFF outside, 0xFFFE unsolvable)
+class SolutionDatabase {
+public:
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint16_t RANKING_LANE_COMBINATIONS = 1;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint16_t rows;
+        uint16_t cols;
+        int16_t goal_row;
+        int16_t goal_col;
+        uint16_t piece_count;
+        uint16_t ranking;
+        uint32_t reserved;
+        uint64_t rank_count;
+        uint64_t distances_offset;
+    };
+
+    struct PieceRecord {
+        char id[4];
+        uint8_t length;
+        uint8_t orientation;
+        uint8_t lane;
+        uint8_t lane_position;  // Order among the pieces sharing the lane, which never changes
+    };
+private:
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+    const FileHeader* header = nullptr;
+    const PieceRecord* records = nullptr;
+    const uint16_t* distances = nullptr;
+    bool same_piece(const PieceRecord& record, const PieceInfo& info) const;
+public:
+    SolutionDatabase(const std::string& path);
+    ~SolutionDatabase();
+    SolutionDatabase(const SolutionDatabase&) = delete;
+    SolutionDatabase& operator=(const SolutionDatabase&) = delete;
+
+    static void write(const std::string& path, const RetrogradeAnalysis& analysis);
+
+    // Whether the file describes this puzzle's pieces and goal
+    bool matches(const PieceTable& table) const;
+    // Ranks states of table the way the file does; throws if the file is for a different puzzle
+    StateRanker make_ranker(const PieceTable& table) const;
+    // Optimal number of moves to the goal, or -1 if the state is unsolvable or not in the file
+    int distance(const StateRanker& ranker, const State& state) const;
+    // A move that starts an optimal solution; false at a goal or when the state is not solvable
+    bool best_move(const PieceTable& table, const StateRanker& ranker, const State& state, Move& move) const;
+    uint64_t size() const { return header->rank_count; }
+};
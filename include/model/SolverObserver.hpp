@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include "State.hpp"
+
+// Receives every state a solver expands. Solvers default to NullObserver so a headless solve does no I/O.
+class SolverObserver {
+public:
+    virtual ~SolverObserver() = default;
+    virtual void on_expand(const PieceTable& table, const State& state) = 0;
+    // An anytime solver found a better solution, at most bound times longer than the shortest one
+    virtual void on_solution(int move_count, double bound) { (void)move_count; (void)bound; }
+};
+
+class NullObserver : public SolverObserver {
+public:
+    void on_expand(const PieceTable&, const State&) override {}
+};
+
+class CountingObserver : public SolverObserver {
+private:
+    uint64_t count = 0;
+public:
+    void on_expand(const PieceTable&, const State&) override { count++; }
+    uint64_t get_count() const { return count; }
+    void reset() { count = 0; }
+};
+
+// Redraws the board being expanded, but at most max_fps times per second
+class SampledVisualizer : public SolverObserver {
+private:
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point last_draw;
+    uint64_t count = 0;
+public:
+    SampledVisualizer(int max_fps = 10);
+    void on_expand(const PieceTable& table, const State& state) override;
+    void on_solution(int move_count, double bound) override;
+};
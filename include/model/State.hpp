@@ -0,0 +1,128 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Board.hpp"
+#include "Piece.hpp"
+#include "Position.h"
+
+constexpr int MAX_PIECES = 64;
+constexpr int MAX_CELLS = 256;
+
+using Bitboard = std::bitset<MAX_CELLS>;
+using OwnerGrid = std::array<int8_t, MAX_CELLS>;
+
+class StateException : public std::exception {
+private:
+    std::string message;
+public:
+    StateException(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override {
+        return message.c_str();
+    }
+};
+
+struct PieceInfo {
+    std::string id;
+    int length;
+    Orientation orientation;
+    Color color;
+    int lane;       // Row of a horizontal piece, column of a vertical piece
+    int lane_size;  // Number of cells the piece can slide along
+};
+
+struct Move {
+    uint8_t piece;
+    uint8_t from;
+    uint8_t to;
+};
+
+// Per-state data: the offset of every piece along its lane, indexed like PieceTable::get_pieces(),
+// plus its Zobrist hash which PieceTable keeps up to date as pieces slide.
+struct State {
+    std::array<uint8_t, MAX_PIECES> offsets{};
+    uint64_t hash = 0;
+    bool operator==(const State& other) const { return hash == other.hash && offsets == other.offsets; }
+    bool operator!=(const State& other) const { return !(*this == other); }
+};
+
+namespace std {
+    template<>
+    struct hash<State> {
+        size_t operator()(const State& s) const {
+            return static_cast<size_t>(s.hash);
+        }
+    };
+}
+
+struct HashStats {
+    size_t elements = 0;
+    size_t buckets = 0;
+    size_t collisions = 0;     // Elements that landed in an already occupied bucket
+    size_t longest_chain = 0;
+};
+
+// Everything about a puzzle that does not change while solving it, shared by all its states.
+class PieceTable {
+private:
+    int rows;
+    int cols;
+    Position goal_pos;
+    std::vector<PieceInfo> pieces;
+    int primary;
+    int goal_min;
+    int goal_max;
+    int lane_stride;
+    std::vector<uint64_t> zobrist;
+public:
+    PieceTable(const Board& board);
+    int get_rows() const { return rows; }
+    int get_cols() const { return cols; }
+    Position get_goal_pos() const { return goal_pos; }
+    const std::vector<PieceInfo>& get_pieces() const { return pieces; }
+    int get_primary() const { return primary; }
+    int size() const { return static_cast<int>(pieces.size()); }
+    int cell_index(int piece, int offset) const {
+        const PieceInfo& info = pieces[piece];
+        return info.orientation == Orientation::HORIZONTAL ? info.lane * cols + offset : offset * cols + info.lane;
+    }
+    int cell_step(int piece) const { return pieces[piece].orientation == Orientation::HORIZONTAL ? 1 : cols; }
+    Position get_head(const State& state, int piece) const;
+    State encode(const Board& board) const;
+    Board decode(const State& state) const;
+    Bitboard occupancy(const State& state) const;
+    OwnerGrid owners(const State& state) const;
+    int count_positions(const State& state, const Bitboard& occupied, int piece) const;
+    void get_moves(const State& state, std::vector<Move>& moves) const;
+    uint64_t zobrist_key(int piece, int offset) const { return zobrist[piece * lane_stride + offset]; }
+    void apply_move(State& state, const Move& move) const {
+        state.offsets[move.piece] = move.to;
+        state.hash ^= zobrist_key(move.piece, move.from) ^ zobrist_key(move.piece, move.to);
+    }
+    void undo_move(State& state, const Move& move) const {
+        state.offsets[move.piece] = move.from;
+        state.hash ^= zobrist_key(move.piece, move.from) ^ zobrist_key(move.piece, move.to);
+    }
+    bool is_goal(const State& state) const;
+    bool enumerate_goals(const State& start, std::vector<State>& goals, size_t limit) const;
+    size_t legacy_hash(const State& state) const;
+};
+
+// Packs a State's offsets into a fixed number of 64-bit words, each piece taking just enough bits for
+// its lane. Records are compared word by word, which is all sorting and merging on disk needs.
+// Typical boards fit in one or two words, a fraction of a State's size.
+class StateCodec {
+private:
+    const PieceTable* table;
+    std::vector<int> widths;    // Bits per piece
+    int words = 1;
+public:
+    StateCodec(const PieceTable& table);
+    int get_words() const { return words; }
+    size_t record_bytes() const { return words * sizeof(uint64_t); }
+    void pack(const State& state, uint64_t* record) const;
+    // Rebuilds the offsets and their Zobrist hash
+    State unpack(const uint64_t* record) const;
+};
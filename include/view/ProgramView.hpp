@@ -1,3 +1,4 @@
+#pragma once
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -14,8 +15,11 @@ public:
     std::string get_user_input();
     void display_algorithms();
     void display_heuristics();
+    void display_observer_modes();
+    void display_batch_usage();
     void display_loader();
     void display_main_menu(const Board& initial_board);
+    void display_database_prompt();
     void pause();
     std::string normalizeString(const std::string& input);
 };
\ No newline at end of file
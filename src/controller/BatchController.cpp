@@ -0,0 +1,300 @@
+#include "BatchController.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include "model/Corpus.hpp"
+#include "model/WorkQueue.hpp"
+
+BatchController::BatchController() {
+    view = std::make_shared<ProgramView>();
+}
+
+bool BatchController::is_batch_invocation(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--batch") {
+            return true;
+        }
+    }
+    return false;
+}
+
+BatchOptions BatchController::parse_arguments(int argc, char** argv) {
+    BatchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            throw BatchException("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--batch") {
+            options.directory = value;
+        } else if (arg == "--algo") {
+            options.algorithm = view->normalizeString(value);
+        } else if (arg == "--heuristic") {
+            options.heuristics = view->normalizeString(value);
+        } else if (arg == "--out") {
+            options.output = value;
+        } else if (arg == "--threads") {
+            try {
+                options.threads = std::stoi(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid thread count: " + value);
+            }
+            if (options.threads < 0) {
+                throw BatchException("Invalid thread count: " + value);
+            }
+        } else if (arg == "--ida-tt-mb") {
+            if (value.empty() || value[0] == '-') {
+                throw BatchException("Invalid transposition table size: " + value);
+            }
+            try {
+                options.ida_table_megabytes = std::stoul(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid transposition table size: " + value);
+            }
+        } else if (arg == "--ext-mb") {
+            if (value.empty() || value[0] == '-') {
+                throw BatchException("Invalid external memory budget: " + value);
+            }
+            try {
+                options.external_megabytes = std::stoul(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid external memory budget: " + value);
+            }
+        } else if (arg == "--ext-dir") {
+            options.external_directory = value;
+        } else if (arg == "--beam-width") {
+            if (value.empty() || value[0] == '-') {
+                throw BatchException("Invalid beam width: " + value);
+            }
+            try {
+                options.beam_width = std::stoul(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid beam width: " + value);
+            }
+            if (options.beam_width == 0) {
+                throw BatchException("Invalid beam width: " + value);
+            }
+        } else if (arg == "--time-limit") {
+            try {
+                options.budget.seconds = std::stod(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid time limit: " + value);
+            }
+            if (options.budget.seconds < 0.0) {
+                throw BatchException("Invalid time limit: " + value);
+            }
+        } else if (arg == "--node-limit") {
+            if (value.empty() || value[0] == '-') {
+                throw BatchException("Invalid node limit: " + value);
+            }
+            try {
+                options.budget.nodes = std::stoull(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid node limit: " + value);
+            }
+        } else if (arg == "--memory-limit") {
+            if (value.empty() || value[0] == '-') {
+                throw BatchException("Invalid memory limit: " + value);
+            }
+            try {
+                options.budget.memory_megabytes = std::stoul(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid memory limit: " + value);
+            }
+        } else if (arg == "--db") {
+            options.database = value;
+        } else if (arg == "--cache") {
+            options.cache = value;
+            if (options.cache_capacity == 0) {
+                options.cache_capacity = SolutionCache::DEFAULT_CAPACITY;
+            }
+        } else if (arg == "--cache-size") {
+            if (value.empty() || value[0] == '-') {
+                throw BatchException("Invalid cache size: " + value);
+            }
+            try {
+                options.cache_capacity = std::stoul(value);
+            } catch (const std::exception&) {
+                throw BatchException("Invalid cache size: " + value);
+            }
+            if (options.cache_capacity == 0) {
+                throw BatchException("Invalid cache size: " + value);
+            }
+        } else {
+            throw BatchException("Unknown argument: " + arg);
+        }
+    }
+    if (options.directory.empty()) {
+        throw BatchException("No puzzle directory given");
+    }
+    return options;
+}
+
+std::vector<std::string> BatchController::collect_files(const std::string& directory) {
+    namespace fs = std::filesystem;
+    if (!fs::is_directory(directory)) {
+        throw BatchException("Not a directory: " + directory);
+    }
+    std::vector<std::string> files;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && !name.empty() && name[0] != '.') {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+BatchRow BatchController::solve_file(const std::string& filepath, const BatchOptions& options, std::shared_ptr<SolutionCache> cache,
+                                     std::shared_ptr<const SolutionDatabase> database) {
+    return solve_puzzle(filepath, [&](ProgramModel& model) { model.load_board(filepath); }, options, cache, database);
+}
+
+BatchRow BatchController::solve_puzzle(const std::string& label, const std::function<void(ProgramModel&)>& load, const BatchOptions& options, std::shared_ptr<SolutionCache> cache,
+                                       std::shared_ptr<const SolutionDatabase> database) {
+    BatchRow row;
+    row.file = label;
+    try 
+    {
+        ProgramModel model;
+        model.set_ida_table_megabytes(options.ida_table_megabytes);
+        model.set_external_memory(options.external_megabytes, options.external_directory);
+        model.set_beam_width(options.beam_width);
+        model.set_solution_cache(cache);
+        model.set_solution_database(database);
+        load(model);
+        Algorithms::Result result = model.run_solver(options.algorithm, options.heuristics, options.budget);
+        if (result.status == SolveStatus::BUDGET_EXCEEDED) {
+            row.status = "budget_exceeded";
+        } else if (result.status == SolveStatus::CANCELLED) {
+            row.status = "cancelled";
+        } else {
+            row.status = result.path.empty() ? "unsolved" : "solved";
+        }
+        row.move_count = result.move_count;
+        row.states_explored = result.states_explored;
+        row.time_taken = result.time_taken;
+    } 
+    catch (const std::exception& e) 
+    {
+        row.status = "error";
+        row.error = e.what();
+    }
+    return row;
+}
+
+static std::string csv_field(const std::string& value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) {
+        return value;
+    }
+    std::string quoted = "\"";
+    for (char c : value) {
+        if (c == '"') {
+            quoted += '"';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void BatchController::write_csv(std::ostream& out, const std::vector<BatchRow>& rows) {
+    out << "file,status,moves,states_explored,time_seconds,error\n";
+    for (const auto& row : rows) {
+        out << csv_field(row.file) << ',' << row.status << ',' << row.move_count << ','
+            << row.states_explored << ',' << row.time_taken << ',' << csv_field(row.error) << '\n';
+    }
+}
+
+int BatchController::run(int argc, char** argv) {
+    BatchOptions options;
+    std::vector<std::string> files;
+    std::unique_ptr<CorpusReader> corpus;
+    std::vector<CorpusPuzzle> puzzles;
+    try 
+    {
+        options = parse_arguments(argc, argv);
+        if (std::filesystem::is_regular_file(options.directory)) {
+            corpus = std::make_unique<CorpusReader>(options.directory);
+            CorpusPuzzle puzzle;
+            while (corpus->next(puzzle)) {
+                puzzles.push_back(puzzle);
+            }
+        } else {
+            files = collect_files(options.directory);
+        }
+    } 
+    catch (const BatchException& e) 
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        view->display_batch_usage();
+        return 1;
+    }
+    catch (const CorpusException& e) 
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    size_t count = corpus ? puzzles.size() : files.size();
+    // Each task owns its ProgramModel and solver, and writes only its own slot, so rows stay in input order.
+    // Only the solution cache and the read-only solution database are shared, so repeated puzzles are
+    // solved once and the database is mapped once. Without --cache or --cache-size every puzzle is
+    // searched, so the times are real.
+    std::shared_ptr<SolutionCache> cache;
+    std::shared_ptr<const SolutionDatabase> database;
+    try 
+    {
+        if (options.cache_capacity > 0) {
+            cache = std::make_shared<SolutionCache>(options.cache_capacity, options.cache);
+        }
+        if (!options.database.empty()) {
+            database = std::make_shared<const SolutionDatabase>(options.database);
+        }
+    } 
+    catch (const SolutionCacheException& e) 
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    catch (const SolutionDatabaseException& e) 
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::vector<BatchRow> rows(count);
+    int threads = options.threads == 0 ? default_thread_count() : options.threads;
+    run_work_queue(count, threads, [&](size_t i) {
+        if (corpus) {
+            // Boards are built inside the task, straight from the mapped cells
+            const CorpusPuzzle& puzzle = puzzles[i];
+            rows[i] = solve_puzzle(options.directory + ":" + std::to_string(puzzle.line),
+                                   [&](ProgramModel& model) { model.set_initial_board(corpus->make_board(puzzle)); }, options, cache, database);
+        } else {
+            rows[i] = solve_file(files[i], options, cache, database);
+        }
+    });
+    if (cache) {
+        std::cerr << "Solution cache: " << cache->get_hits() << " hits, " << cache->get_misses() << " misses" << std::endl;
+        // Written once all puzzles are done; the rows stand whether or not the file could be written
+        try 
+        {
+            cache->save();
+        } 
+        catch (const SolutionCacheException& e) 
+        {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
+    if (options.output.empty()) {
+        write_csv(std::cout, rows);
+    } else {
+        std::ofstream out(options.output);
+        if (!out.is_open()) {
+            std::cerr << "Error: could not open " << options.output << std::endl;
+            return 1;
+        }
+        write_csv(out, rows);
+    }
+    return 0;
+}
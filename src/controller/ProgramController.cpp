@@ -3,6 +3,8 @@
 ProgramController::ProgramController() {
     model = std::make_shared<ProgramModel>();
     model->init();
+    // Puzzles are often solved again in the same session
+    model->set_solution_cache(std::make_shared<SolutionCache>());
 }
 
 void ProgramController::init() {
@@ -44,12 +46,49 @@ void ProgramController::main_menu() {
         || view->normalizeString(choice) == view->normalizeString("Quit")) {
             exit();
             break;
+        } else if (view->normalizeString(choice) == view->normalizeString("Save Database") || choice == "4") {
+            save_database();
+            break;
+        } else if (view->normalizeString(choice) == view->normalizeString("Load Database") || choice == "5") {
+            load_database();
+            break;
         } else {
             std::cout << "Invalid choice. Please try again." << std::endl;
         }
     }
 }
 
+void ProgramController::save_database() {
+    view->display_database_prompt();
+    std::string filepath = view->get_user_input();
+    try 
+    {
+        std::cout << "Analysing every reachable state..." << std::endl;
+        model->save_solution_database(filepath);
+        std::cout << "Solution database written to " << filepath << std::endl;
+    } 
+    catch (const std::exception& e) 
+    {
+        std::cerr << "Error saving solution database: " << e.what() << std::endl;
+    }
+    view->pause();
+}
+
+void ProgramController::load_database() {
+    view->display_database_prompt();
+    std::string filepath = view->get_user_input();
+    try 
+    {
+        model->load_solution_database(filepath);
+        std::cout << "Solution database loaded, select Solution Database in the solver menu to use it" << std::endl;
+    } 
+    catch (const std::exception& e) 
+    {
+        std::cerr << "Error loading solution database: " << e.what() << std::endl;
+    }
+    view->pause();
+}
+
 void ProgramController::exit() {
     std::cout << "Exiting the program." << std::endl;
     std::exit(0);
@@ -66,14 +105,23 @@ void ProgramController::solver() {
         view->display_heuristics();
         temp = view->get_user_input();
         std::string heuristics = view->normalizeString(temp);
-        while (heuristics != "blockedcarheuristic" && heuristics != "manhattandistance") {
+        while (heuristics != "blockedcarheuristic" && heuristics != "manhattandistance" && heuristics != "patterndatabase") {
             std::cout << "Invalid choice. Please try again." << std::endl;
             temp = view->get_user_input();
             heuristics = view->normalizeString(temp);
         }
+        view->display_observer_modes();
+        temp = view->get_user_input();
+        std::string mode = view->normalizeString(temp);
+        while (mode != "none" && mode != "live" && mode != "counter" && mode != "1" && mode != "2" && mode != "3") {
+            std::cout << "Invalid choice. Please try again." << std::endl;
+            temp = view->get_user_input();
+            mode = view->normalizeString(temp);
+        }
+        set_observer_mode(mode);
         try 
         {
-            run_solver(algorithm);
+            run_solver(algorithm, heuristics);
             break;
         } 
         catch (const std::exception& e) 
@@ -85,17 +133,9 @@ void ProgramController::solver() {
 }
 
 void ProgramController::load_board(const std::string& filepath) {
-    std::ifstream file(filepath);
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + filepath);
-    }
-
     try 
     {
-        auto [rows, cols] = Reader::read_dimensions(file);
-        int secondary_count = Reader::read_secondary_count(file);
-        std::vector<std::string> board_config = Reader::read_board_config(file, rows, cols);
-        model->create_board(rows, cols, secondary_count, board_config);
+        model->load_board(filepath);
     }
     catch (const ConfigFileException& e) 
     {
@@ -105,7 +145,27 @@ void ProgramController::load_board(const std::string& filepath) {
     {
         throw std::runtime_error("Error reading board configuration: " + std::string(e.what()));
     }
-    file.close();
+    Board board = model->get_initial_board();
+    Position goal_pos = board.get_goal_pos();
+    std::cout << "Goal position: " << goal_pos.row << ", " << goal_pos.col << std::endl;
+    for (const auto& [id, piece] : board.get_pieces()) {
+        if (id != "P") {
+            std::cout << "Secondary car: " << id << std::endl;
+        }
+    }
+    view->pause();
+}
+
+void ProgramController::set_observer_mode(const std::string& mode) {
+    counter = nullptr;
+    if (mode == "live" || mode == "2") {
+        model->set_observer(std::make_shared<SampledVisualizer>(10));
+    } else if (mode == "counter" || mode == "3") {
+        counter = std::make_shared<CountingObserver>();
+        model->set_observer(counter);
+    } else {
+        model->set_observer(nullptr);
+    }
 }
 
 void ProgramController::run_solver(const std::string& algorithm, const std::string& heuristics) {
@@ -113,12 +173,25 @@ void ProgramController::run_solver(const std::string& algorithm, const std::stri
     try 
     {
         std::cout << "Running solver..." << std::endl;
-        sol = model->run_solver(algorithm);
+        sol = model->run_solver(algorithm, heuristics);
     } 
     catch (const std::exception& e) 
     {
         throw std::runtime_error(std::string(e.what()));
     }
+    if (counter) {
+        std::cout << "Expansions counted: " << counter->get_count() << std::endl;
+    }
+    if (auto cache = model->get_solution_cache()) {
+        std::cout << "Solution cache: " << cache->get_hits() << " hits, " << cache->get_misses() << " misses" << std::endl;
+    }
+    if (sol.status != SolveStatus::FINISHED) {
+        std::cout << (sol.status == SolveStatus::CANCELLED ? "Search cancelled." : "Search budget exceeded.") << std::endl;
+        if (!sol.partial_path.empty()) {
+            std::cout << "Closest state reached, " << sol.partial_path.size() - 1 << " moves in:" << std::endl;
+            std::cout << sol.partial_path.back().to_string() << std::endl;
+        }
+    }
     if (sol.path.empty()) {
         std::cout << "No solution found." << std::endl;
         view->pause();
@@ -1,6 +1,11 @@
 #include "controller/ProgramController.hpp"
+#include "controller/BatchController.hpp"
 
-int main() {
+int main(int argc, char** argv) {
+    if (BatchController::is_batch_invocation(argc, argv)) {
+        BatchController batch;
+        return batch.run(argc, argv);
+    }
     ProgramController controller;
     controller.init();
     while (true) {
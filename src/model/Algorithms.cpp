@@ -1,415 +1,661 @@
 #include "Algorithms.hpp"
 
-Steps::Steps(const Board& board) : board(board) {
-    for (const auto& [id, piece] : board.get_pieces()) {
-        pieces[id] = piece->get_head();
-    }
-}
-
-Steps::Steps(const Steps& other) : board(Board(other.board)) {
-    pieces = other.pieces;
+Steps::Steps(const Board& board) : table(std::make_shared<const PieceTable>(board)) {
+    state = table->encode(board);
 }
 
-Steps& Steps::operator=(const Steps& other) {
-    if (this != &other) {
-        board = other.board;
-        pieces = other.pieces;
+std::map<std::string, Position> Steps::get_pieces() const {
+    std::map<std::string, Position> pieces;
+    for (int i = 0; i < table->size(); ++i) {
+        pieces[table->get_pieces()[i].id] = table->get_head(state, i);
     }
-    return *this;
+    return pieces;
 }
 
 std::vector<Steps> Steps::get_possible_steps() const {
     std::vector<Steps> possible_steps;
-    for (const auto& [id, piece] : board.get_pieces()) {
-        for (const auto& pos : board.get_possible_positions(piece)) {
-            Board new_board = board;
-            try{
-                new_board.move_piece(id, pos);
-                possible_steps.emplace_back(new_board);
-            } catch (const Board::InvalidMoveException& e) {
-                continue;
-            } catch (const Board::InvalidPositionException& e) {
-                continue;
-            } catch (const Board::PieceNotFoundException& e) {
-                continue;
-            }
-        }
+    std::vector<Move> moves;
+    table->get_moves(state, moves);
+    for (const auto& move : moves) {
+        State next = state;
+        table->apply_move(next, move);
+        possible_steps.emplace_back(table, next);
     }
     return possible_steps;
 }
 
-bool Steps::operator==(const Steps& other) const {
-    if (pieces.size() != other.pieces.size()) {
-        return false;
-    }
-    
-    for (const auto& [id, pos] : pieces) {
-        auto it = other.pieces.find(id);
-        if (it == other.pieces.end()) {
-            return false;
-        }
-        
-        if (it->second.row != pos.row || it->second.col != pos.col) {
-            return false;
-        }
-    }
-    
-    return true;
-}
-
-size_t Steps::hash() const {
-    size_t result = 0;
-    const size_t prime = 31;
-    
-    for (const auto& [id, pos] : pieces) {
-        size_t piece_hash = std::hash<std::string>{}(id);
-        piece_hash = piece_hash * prime + std::hash<int>{}(pos.row);
-        piece_hash = piece_hash * prime + std::hash<int>{}(pos.col);
-        result = result * prime + piece_hash;
-    }
-    
-    return result;
-}
-
-bool Steps::is_goal() const {
-    Position goal_pos = board.get_goal_pos();
-    auto primary_iter = board.get_pieces().find("P");
-    if (primary_iter == board.get_pieces().end()) {
-        return false;
-    }
-    auto primary_car = primary_iter->second;
-    std::vector<Position> primary_positions = primary_car->get_positions();
-    for (const auto& pos : primary_positions) {
-        if (pos == goal_pos) {
-            return true;
-        }
-    }
-    return false;
-}
-
 std::string Steps::to_string() const {
     std::ostringstream oss;
-    oss << board.to_string();
+    oss << get_board().to_string();
     return oss.str();
 }
 
-namespace std {
-    template<>
-    struct hash<Steps> {
-        size_t operator()(const Steps& s) const {
-            return s.hash();
-        }
-    };
-}
-
-std::vector<Steps> Algorithms::get_path(std::unordered_map<Steps, Steps>& from, Steps& goal, Steps& start) {
+std::vector<Steps> Algorithms::get_path(const std::shared_ptr<const PieceTable>& table, const NodeArena& arena, uint32_t goal) {
     std::vector<Steps> path;
-    Steps current = goal;
-    path.push_back(current);
-    while (from.find(current) != from.end()) {
-        current = from[current];
-        path.insert(path.begin(), current);
-    }
-    if (path.empty() || !(path.front() == start)) {
-        path.insert(path.begin(), start);
+    for (uint32_t i : arena.trace(goal)) {
+        path.emplace_back(table, arena[i].state);
     }
-    
     return path;
 }
 
-double Algorithms::blocked_car_heuristic(const Steps& state) {
-    const Board& board = state.get_board();
-    auto primary = board.get_piece("P");
-    
-    if (!primary) return 0.0;
-    auto orientation = primary->get_orientation();
-    auto primary_positions = primary->get_positions();
-    Position goal_pos = board.get_goal_pos();
-    if (orientation == Orientation::VERTICAL) {
+// Compiled to a no-op unless RUSHHOUR_HASH_DEBUG is defined
+void Algorithms::report_hash_stats(const PieceTable& table, const NodeArena& arena) {
+#ifdef RUSHHOUR_HASH_DEBUG
+    HashStats zobrist = arena.bucket_stats([](const State& state) { return std::hash<State>{}(state); });
+    HashStats legacy = arena.bucket_stats([&table](const State& state) { return table.legacy_hash(state); });
+    std::cerr << "Hash buckets: " << zobrist.buckets << ", states: " << zobrist.elements << std::endl;
+    std::cerr << "  zobrist collisions: " << zobrist.collisions << ", longest chain: " << zobrist.longest_chain << std::endl;
+    std::cerr << "  legacy collisions:  " << legacy.collisions << ", longest chain: " << legacy.longest_chain << std::endl;
+#else
+    (void)table;
+    (void)arena;
+#endif
+}
+
+void Algorithms::prepare_heuristic(const PieceTable& table, const State& start) {
+    pattern_database = heuristics == "patterndatabase" ? PatternDatabase::load(table, start) : nullptr;
+}
+
+double Algorithms::blocked_car_heuristic(const PieceTable& table, const State& state) {
+    int primary = table.get_primary();
+    if (primary == -1) return 0.0;
+    const PieceInfo& primary_info = table.get_pieces()[primary];
+    if (primary_info.orientation == Orientation::VERTICAL) {
         return 100.0;
     }
-    int primary_rightmost = -1;
-    for (const auto& pos : primary_positions) {
-        if (pos.col > primary_rightmost) {
-            primary_rightmost = pos.col;
-        }
-    }
-    int primary_row = primary_positions[0].row;
+    int cols = table.get_cols();
+    int primary_rightmost = state.offsets[primary] + primary_info.length - 1;
+    int primary_row = primary_info.lane;
+    int goal_col = table.get_goal_pos().col;
+    OwnerGrid owners = table.owners(state);
+    Bitboard occupied = table.occupancy(state);
     double blocking_count = 0;
-    int goal_col = (goal_pos.col == board.get_cols() - 1) ? goal_pos.col : goal_pos.col;
-    for (int col = primary_rightmost + 1; col <= goal_col; col++) {
-        Position check_pos(primary_row, col);
-        if (col < board.get_cols() && !board.get_cell(check_pos).get_is_empty()) {
-            auto blocking_piece = board.get_cell(check_pos).get_piece();
-            if (blocking_piece->get_orientation() == Orientation::VERTICAL) {
-                blocking_count += 2.0;
-            } else {
-                blocking_count += 1.0;
-            }
-        }
-    }
-    double distance = goal_col - primary_rightmost;
     double indirect_blocking = 0.0;
-    for (const auto& [id, piece] : board.get_pieces()) {
-        if (id == "P") continue;
-        bool is_direct_blocker = false;
-        for (const auto& pos : piece->get_positions()) {
-            if (pos.row == primary_row && pos.col > primary_rightmost && pos.col <= goal_col) {
-                is_direct_blocker = true;
-                break;
-            }
+    int last_blocker = -1;
+    for (int col = primary_rightmost + 1; col <= goal_col && col < cols; col++) {
+        int blocker = owners[primary_row * cols + col];
+        if (blocker == -1) {
+            continue;
         }
-        
-        if (is_direct_blocker) {
-            auto orientation = piece->get_orientation();
-            
-            if (orientation == Orientation::VERTICAL) {
-                bool can_move = false;
-                std::vector<Position> possible_positions = board.get_possible_positions(piece);
-                if (possible_positions.size() <= 1) {
-                    indirect_blocking += 1.0;
-                }
-            } else {
-                std::vector<Position> possible_positions = board.get_possible_positions(piece);
-                if (possible_positions.size() <= 1) {
-                    indirect_blocking += 1.0;
-                }
-            }
+        if (table.get_pieces()[blocker].orientation == Orientation::VERTICAL) {
+            blocking_count += 2.0;
+        } else {
+            blocking_count += 1.0;
+        }
+        // A horizontal blocker spans several columns but only counts once
+        if (blocker != last_blocker && table.count_positions(state, occupied, blocker) <= 1) {
+            indirect_blocking += 1.0;
         }
+        last_blocker = blocker;
     }
+    double distance = goal_col - primary_rightmost;
     double heuristic = distance + (blocking_count * 1.5) + (indirect_blocking * 0.5);
     
     return heuristic;
 }
 
-double Algorithms::manhattan_distance(const Steps& state) {
-    auto primary = state.get_board().get_piece("P");
-    auto primary_pos = primary->get_positions();
-    auto goal_pos = state.get_board().get_goal_pos();
-    Position closest = primary_pos[0];
-    for (const auto& pos : primary_pos) {
-        if (pos.col > closest.col) {
-            closest = pos;
+double Algorithms::manhattan_distance(const PieceTable& table, const State& state) {
+    int primary = table.get_primary();
+    const PieceInfo& primary_info = table.get_pieces()[primary];
+    int closest_col = primary_info.orientation == Orientation::HORIZONTAL ? state.offsets[primary] + primary_info.length - 1 : primary_info.lane;
+    return std::abs(closest_col - table.get_goal_pos().col);
+}
+
+Algorithms::Result Algorithms::finish(Result result, const SearchStats& stats) {
+    stats.append_to(result.extra_stats);
+    return result;
+}
+
+// Leaves the result alone when the search was not stopped
+Algorithms::Result Algorithms::interrupted(Result result, const BudgetGuard& guard, const std::shared_ptr<const PieceTable>& table, const NodeArena& arena) {
+    if (!guard.stopped()) {
+        return result;
+    }
+    result.status = guard.get_status();
+    uint32_t best = NO_PARENT;
+    int best_distance = std::numeric_limits<int>::max();
+    for (uint32_t i = 0; i < arena.size(); ++i) {
+        int distance = progress(*table, arena[i].state);
+        if (distance < best_distance || (distance == best_distance && arena[i].g < arena[best].g)) {
+            best = i;
+            best_distance = distance;
         }
     }
-    return std::abs(closest.col - goal_pos.col);
+    if (best != NO_PARENT) {
+        result.partial_path = get_path(table, arena, best);
+    }
+    return result;
 }
 
 Algorithms::Result AStar::solve(const Board& board) {
     auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
     int states_explored = 0;
-    Steps start(board);
-    if (start.is_goal()) {
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    prepare_heuristic(*table, start);
+    if (table->is_goal(start)) {
         auto end_time = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed_time = end_time - start_time;
-        std::vector<Steps> path = {start};
+        std::vector<Steps> path = {Steps(table, start)};
         return {path, 0, 1, elapsed_time.count()};
     }
-    std::priority_queue<std::pair<double, Steps>, std::vector<std::pair<double, Steps>>,PQCompare<double>> frontier;
-    std::unordered_set<Steps> closed_set;
-    std::unordered_map<Steps, Steps> from;
-    std::unordered_map<Steps, double> g_score;
-    g_score[start] = 0.0;
-    std::unordered_map<Steps, double> f_score;
-    if (heuristics == "blockedcarheuristic") {
-        f_score[start] = blocked_car_heuristic(start);
-    } else if (heuristics == "manhattandistance") {
-        f_score[start] = manhattan_distance(start);
-    }
-    frontier.push({f_score[start], start});
+    SearchStats stats;
+    OpenList frontier(heuristic_scale());
+    NodeArena arena;
+    std::vector<Move> moves;
+    uint32_t root = arena.insert(start, NO_PARENT, {}, 0.0).first;
+    double start_h = heuristic(*table, start);
+    frontier.push(start_h, start_h, root);
     while (!frontier.empty()) {
-        auto current = frontier.top().second;
-        frontier.pop();
+        if (guard.exceeded(states_explored, [&] { return arena.memory_usage() + frontier.size() * sizeof(std::pair<double, uint32_t>); })) {
+            break;
+        }
+        uint32_t current = stats.timed(SearchStats::QUEUE, [&] { return frontier.pop(); });
         states_explored++;
-        std::system("clear");
-        std::cout << current.get_board().to_string() << std::endl;
-        if(current.is_goal()){
+        State state = arena[current].state;
+        observer->on_expand(*table, state);
+        if(table->is_goal(state)){
             auto end_time = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> elapsed_time = end_time - start_time;
-            std::vector<Steps> path = get_path(from, current, start);
-            return {path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()};
+            std::vector<Steps> path = get_path(table, arena, current);
+            report_hash_stats(*table, arena);
+            stats.memory(arena.memory_usage(), arena.size());
+            return finish({path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()}, stats);
         }
-        if (closed_set.find(current) != closed_set.end()) {
+        if (arena[current].closed) {
             continue;
         }
-        closed_set.insert(current);
-        for (const auto& next : current.get_possible_steps()) {
-            if (closed_set.find(next) != closed_set.end()) {
-                continue;
-            }
-            double tentative_g_score = g_score[current] + 1.0;
-            if (g_score.find(next) == g_score.end() || tentative_g_score < g_score[next]) {
-                from[next] = current;
-                g_score[next] = tentative_g_score;
-                if (heuristics == "blockedcarheuristic") {
-                    f_score[next] = tentative_g_score + blocked_car_heuristic(next);
-                } else if (heuristics == "manhattandistance") {
-                    f_score[next] = tentative_g_score + manhattan_distance(next);
+        arena[current].closed = true;
+        stats.closed();
+        double current_g_score = arena[current].g;
+        stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+        stats.generated(moves.size());
+        for (const auto& move : moves) {
+            State next = state;
+            table->apply_move(next, move);
+            double tentative_g_score = current_g_score + 1.0;
+            auto [id, inserted] = stats.timed(SearchStats::HASHING, [&] { return arena.insert(next, current, move, tentative_g_score); });
+            if (!inserted) {
+                Node& node = arena[id];
+                if (node.closed || tentative_g_score >= node.g) {
+                    stats.duplicate();
+                    continue;
                 }
-                
-                frontier.push({f_score[next], next});
+                node.parent = current;
+                node.move = move;
+                node.g = tentative_g_score;
+                stats.updated();
             }
+            double h = stats.timed(SearchStats::HEURISTIC, [&] { return heuristic(*table, next); });
+            stats.timed(SearchStats::QUEUE, [&] { frontier.push(tentative_g_score + h, h, id); });
         }
+        stats.open_size(frontier.size());
     }
+    report_hash_stats(*table, arena);
+    stats.memory(arena.memory_usage(), arena.size());
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed_time = end_time - start_time;
-    return {{}, 0, states_explored, elapsed_time.count()};
+    return finish(interrupted({{}, 0, states_explored, elapsed_time.count()}, guard, table, arena), stats);
 }
 
 Algorithms::Result GBFS::solve(const Board& board) {
     auto start_time = std::chrono::high_resolution_clock::now();
-    int states_explored = 0;
-    Steps start(board);
-    if (start.is_goal()) {
+    BudgetGuard guard(budget);
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    prepare_heuristic(*table, start);
+    if (table->is_goal(start)) {
         auto end_time = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed_time = end_time - start_time;
-        std::vector<Steps> path = {start};
+        std::vector<Steps> path = {Steps(table, start)};
         return {path, 0, 1, elapsed_time.count()};
     }
-    std::priority_queue<std::pair<double, Steps>, std::vector<std::pair<double, Steps>>, PQCompare<double>> frontier;
-    std::unordered_set<Steps> visited;
-    std::unordered_map<Steps, Steps> from;
-    if (heuristics == "blockedcarheuristic") {
-        frontier.push({blocked_car_heuristic(start), start});
-    } else if (heuristics == "manhattandistance") {
-        frontier.push({manhattan_distance(start), start});
+    StateCodec codec(*table);
+    if (codec.get_words() == 1) {
+        return solve_packed<1>(table, start, codec, guard, start_time);
+    } else if (codec.get_words() == 2) {
+        return solve_packed<2>(table, start, codec, guard, start_time);
+    }
+    return solve_with_arena(table, start, guard, start_time);
+}
+
+namespace {
+    template<int WORDS>
+    struct PackedEntry {
+        std::array<uint64_t, WORDS> key;
+        uint32_t parent;    // Arena index of the expanded state this one was generated from
+        Move move;
+        uint16_t g;
+        float h;
+    };
+
+    template<int WORDS>
+    struct PackedCompare {
+        bool operator()(const PackedEntry<WORDS>& a, const PackedEntry<WORDS>& b) const {
+            return a.h > b.h;
+        }
+    };
+}
+
+// Only expanded states enter the arena. Successors are pushed as packed keys and a state can be
+// queued more than once; the first copy popped claims it and later ones are dropped as duplicates.
+template<int WORDS>
+Algorithms::Result GBFS::solve_packed(const std::shared_ptr<const PieceTable>& table, const State& start, const StateCodec& codec, BudgetGuard& guard, Clock::time_point start_time) {
+    int states_explored = 0;
+    SearchStats stats;
+    std::priority_queue<PackedEntry<WORDS>, std::vector<PackedEntry<WORDS>>, PackedCompare<WORDS>> frontier;
+    NodeArena arena;
+    std::vector<Move> moves;
+    PackedEntry<WORDS> entry{};
+    codec.pack(start, entry.key.data());
+    entry.parent = NO_PARENT;
+    entry.h = static_cast<float>(heuristic(*table, start));
+    frontier.push(entry);
+    while (!frontier.empty()) {
+        if (guard.exceeded(states_explored, [&] { return arena.memory_usage() + frontier.size() * sizeof(PackedEntry<WORDS>); })) {
+            break;
+        }
+        PackedEntry<WORDS> top = stats.timed(SearchStats::QUEUE, [&] {
+            PackedEntry<WORDS> popped = frontier.top();
+            frontier.pop();
+            return popped;
+        });
+        states_explored++;
+        State state = codec.unpack(top.key.data());
+        observer->on_expand(*table, state);
+        auto [current, inserted] = stats.timed(SearchStats::HASHING, [&] { return arena.insert(state, top.parent, top.move, top.g); });
+        if (!inserted) {
+            stats.duplicate();
+            continue;
+        }
+        if (table->is_goal(state)) {
+            auto end_time = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed_time = end_time - start_time;
+            std::vector<Steps> path = get_path(table, arena, current);
+            report_hash_stats(*table, arena);
+            stats.memory(arena.memory_usage() + frontier.size() * sizeof(PackedEntry<WORDS>), arena.size() + frontier.size());
+            return finish({path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()}, stats);
+        }
+        arena[current].closed = true;
+        stats.closed();
+        stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+        stats.generated(moves.size());
+        for (const auto& move : moves) {
+            table->apply_move(state, move);
+            bool closed = stats.timed(SearchStats::HASHING, [&] { return arena.find(state) != NO_PARENT; });
+            if (closed) {
+                stats.duplicate();
+            } else {
+                codec.pack(state, entry.key.data());
+                entry.parent = current;
+                entry.move = move;
+                entry.g = static_cast<uint16_t>(std::min<int>(top.g + 1, std::numeric_limits<uint16_t>::max()));
+                entry.h = static_cast<float>(stats.timed(SearchStats::HEURISTIC, [&] { return heuristic(*table, state); }));
+                stats.timed(SearchStats::QUEUE, [&] { frontier.push(entry); });
+            }
+            table->undo_move(state, move);
+        }
+        stats.open_size(frontier.size());
     }
+    report_hash_stats(*table, arena);
+    stats.memory(arena.memory_usage(), arena.size());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    return finish(interrupted({{}, 0, states_explored, elapsed_time.count()}, guard, table, arena), stats);
+}
+
+Algorithms::Result GBFS::solve_with_arena(const std::shared_ptr<const PieceTable>& table, const State& start, BudgetGuard& guard, Clock::time_point start_time) {
+    int states_explored = 0;
+    SearchStats stats;
+    std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, PQCompare<double>> frontier;
+    NodeArena arena;
+    std::vector<Move> moves;
+    uint32_t root = arena.insert(start, NO_PARENT, {}, 0.0).first;
+    frontier.push({heuristic(*table, start), root});
     while (!frontier.empty()) {
-        auto current = frontier.top().second;
-        frontier.pop();
+        if (guard.exceeded(states_explored, [&] { return arena.memory_usage() + frontier.size() * sizeof(std::pair<double, uint32_t>); })) {
+            break;
+        }
+        uint32_t current = stats.timed(SearchStats::QUEUE, [&] {
+            uint32_t top = frontier.top().second;
+            frontier.pop();
+            return top;
+        });
         states_explored++;
-        std::system("clear");
-        std::cout << current.get_board().to_string() << std::endl;
-        if (current.is_goal()) {
+        State state = arena[current].state;
+        observer->on_expand(*table, state);
+        if (table->is_goal(state)) {
             auto end_time = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> elapsed_time = end_time - start_time;
-            std::vector<Steps> path = get_path(from, current, start);
-            return {path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()};
+            std::vector<Steps> path = get_path(table, arena, current);
+            report_hash_stats(*table, arena);
+            stats.memory(arena.memory_usage(), arena.size());
+            return finish({path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()}, stats);
         }
-        if (visited.find(current) != visited.end()) {
+        if (arena[current].closed) {
             continue;
         }
-        visited.insert(current);
-        for (const auto& next : current.get_possible_steps()) {
-            if (visited.find(next) != visited.end()) {
-                continue;
-            }
-            if (heuristics == "blockedcarheuristic") {
-                frontier.push({blocked_car_heuristic(next), next});
-            } else if (heuristics == "manhattandistance") {
-                frontier.push({manhattan_distance(next), next});
+        arena[current].closed = true;
+        stats.closed();
+        stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+        stats.generated(moves.size());
+        for (const auto& move : moves) {
+            State next = state;
+            table->apply_move(next, move);
+            auto [id, inserted] = stats.timed(SearchStats::HASHING, [&] { return arena.insert(next, current, move, 0.0); });
+            if (!inserted) {
+                Node& node = arena[id];
+                if (node.closed) {
+                    stats.duplicate();
+                    continue;
+                }
+                node.parent = current;
+                node.move = move;
+                stats.updated();
             }
-            from[next] = current;
+            double h = stats.timed(SearchStats::HEURISTIC, [&] { return heuristic(*table, next); });
+            stats.timed(SearchStats::QUEUE, [&] { frontier.push({h, id}); });
         }
+        stats.open_size(frontier.size());
     }
+    report_hash_stats(*table, arena);
+    stats.memory(arena.memory_usage(), arena.size());
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed_time = end_time - start_time;
-    return {{}, 0, states_explored, elapsed_time.count()};
+    return finish(interrupted({{}, 0, states_explored, elapsed_time.count()}, guard, table, arena), stats);
 }
 
 Algorithms::Result UCS::solve(const Board& board) {
     auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
     int states_explored = 0;
-    Steps start(board);
-    std::priority_queue<std::pair<double, Steps>, std::vector<std::pair<double, Steps>>, PQCompare<double>> frontier;
-    std::unordered_set<Steps> visited;
-    std::unordered_map<Steps, Steps> from;
-    std::unordered_map<Steps, double> g_score;
-    g_score[start] = 0.0;
-    frontier.push({g_score[start], start});
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    SearchStats stats;
+    OpenList frontier(1);
+    NodeArena arena;
+    std::vector<Move> moves;
+    uint32_t root = arena.insert(start, NO_PARENT, {}, 0.0).first;
+    frontier.push(0.0, 0.0, root);
     while (!frontier.empty()) {
-        auto current = frontier.top().second;
-        frontier.pop();
+        if (guard.exceeded(states_explored, [&] { return arena.memory_usage() + frontier.size() * sizeof(std::pair<double, uint32_t>); })) {
+            break;
+        }
+        uint32_t current = stats.timed(SearchStats::QUEUE, [&] { return frontier.pop(); });
         states_explored++;
-        std::system("clear");
-        std::cout << current.get_board().to_string() << std::endl;
-        if (current.is_goal()) {
+        State state = arena[current].state;
+        observer->on_expand(*table, state);
+        if (table->is_goal(state)) {
             auto end_time = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> elapsed_time = end_time - start_time;
-            std::vector<Steps> path = get_path(from, current, start);
-            return {path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()};
+            std::vector<Steps> path = get_path(table, arena, current);
+            report_hash_stats(*table, arena);
+            stats.memory(arena.memory_usage(), arena.size());
+            return finish({path, static_cast<int>(path.size())-1, states_explored, elapsed_time.count()}, stats);
         }
-        if (visited.find(current) != visited.end()) {
+        if (arena[current].closed) {
             continue;
         }
-        visited.insert(current);
-        for (const auto& next : current.get_possible_steps()) {
-            if (visited.find(next) != visited.end()) {
-                continue;
-            }
-            double tentative_g_score = g_score[current] + 1.0;
-            if (g_score.find(next) == g_score.end() || tentative_g_score < g_score[next]) {
-                from[next] = current;
-                g_score[next] = tentative_g_score;
-                frontier.push({g_score[next], next});
+        arena[current].closed = true;
+        stats.closed();
+        double current_g_score = arena[current].g;
+        stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+        stats.generated(moves.size());
+        for (const auto& move : moves) {
+            State next = state;
+            table->apply_move(next, move);
+            double tentative_g_score = current_g_score + 1.0;
+            auto [id, inserted] = stats.timed(SearchStats::HASHING, [&] { return arena.insert(next, current, move, tentative_g_score); });
+            if (!inserted) {
+                Node& node = arena[id];
+                if (node.closed || tentative_g_score >= node.g) {
+                    stats.duplicate();
+                    continue;
+                }
+                node.parent = current;
+                node.move = move;
+                node.g = tentative_g_score;
+                stats.updated();
             }
+            stats.timed(SearchStats::QUEUE, [&] { frontier.push(tentative_g_score, 0.0, id); });
         }
+        stats.open_size(frontier.size());
     }
+    report_hash_stats(*table, arena);
+    stats.memory(arena.memory_usage(), arena.size());
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed_time = end_time - start_time;
-    return {{}, 0, states_explored, elapsed_time.count()};
+    return finish(interrupted({{}, 0, states_explored, elapsed_time.count()}, guard, table, arena), stats);
 }
 
-Algorithms::Result IDA::solve(const Board& board) {
-    auto start_time = std::chrono::high_resolution_clock::now();
-    int states_explored = 0;
-    Steps start(board);
-    std::unordered_map<Steps, Steps> from;
-    if (start.is_goal()) {
-        auto end_time = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> elapsed_time = end_time - start_time;
-        return {{start}, 0, 1, elapsed_time.count()};
-    }
-    double bound = heuristic(start);
-    
-    while (true) {
-        double next_bound = std::numeric_limits<double>::infinity();
-        std::stack<std::pair<Steps, double>> dfs_stack;
-        std::unordered_map<Steps, double> g_score;
-        dfs_stack.push({start, 0.0});
-        g_score[start] = 0.0;
-        std::unordered_set<Steps> visited;
-        while (!dfs_stack.empty()) {
-            auto [current, cost] = dfs_stack.top();
-            dfs_stack.pop();
-            states_explored++;
-            if (visited.find(current) != visited.end()) {
-                continue;
+namespace {
+    struct TranspositionEntry {
+        uint64_t key;
+        uint16_t g;
+        uint16_t iteration;
+        bool cut;       // Reached only beyond the current bound so far
+    };
+
+    // Table of the shallowest depth each state was reached at during the current IDA* iteration. It
+    // starts small and doubles at half load, so an easy board never pays for the full size; only at
+    // the megabyte limit does a full probe window evict an entry. As long as no entry of the iteration
+    // was evicted it is an exact visited set, so an iteration that leaves no state cut off has searched
+    // everything reachable. Entries of earlier iterations count as free slots.
+    class TranspositionTable {
+    private:
+        static constexpr size_t INITIAL_SIZE = 1 << 12;
+        static constexpr size_t PROBE_LIMIT = 8;
+        std::vector<TranspositionEntry> entries;
+        size_t max_size = 0;
+        size_t used = 0;            // Entries of the current iteration
+        uint16_t iteration = 0;
+        size_t cut_entries = 0;
+        bool lossy = false;
+        // The entry holding key, or the first free slot of its probe window, or null if neither exists
+        TranspositionEntry* find(uint64_t key) {
+            size_t mask = entries.size() - 1;
+            for (size_t i = 0; i < PROBE_LIMIT; ++i) {
+                TranspositionEntry& entry = entries[(key + i) & mask];
+                if (entry.iteration != iteration || entry.key == key) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+        void grow() {
+            std::vector<TranspositionEntry> old(entries.size() * 2, TranspositionEntry{0, 0, 0, false});
+            old.swap(entries);
+            for (const auto& entry : old) {
+                if (entry.iteration == iteration) {
+                    if (TranspositionEntry* slot = find(entry.key)) {
+                        *slot = entry;
+                    } else {
+                        lossy = true;
+                        used--;
+                        cut_entries -= entry.cut;
+                    }
+                }
+            }
+        }
+    public:
+        TranspositionTable(size_t megabytes) {
+            size_t capacity = megabytes * 1024 * 1024 / sizeof(TranspositionEntry);
+            if (capacity == 0) {
+                return;
+            }
+            max_size = 1;
+            while (max_size * 2 <= capacity) {
+                max_size *= 2;
             }
-            visited.insert(current);
-            if (current.is_goal()) {
-                auto end_time = std::chrono::high_resolution_clock::now();
-                std::chrono::duration<double> elapsed_time = end_time - start_time;
-                std::vector<Steps> path;
-                path.push_back(current);
-                Steps trace = current;
-                while (from.find(trace) != from.end()) {
-                    trace = from[trace];
-                    path.insert(path.begin(), trace);
+            entries.assign(std::min(max_size, INITIAL_SIZE), {0, 0, 0, false});
+        }
+        bool enabled() const { return !entries.empty(); }
+        size_t memory_usage() const { return entries.capacity() * sizeof(TranspositionEntry); }
+        void next_iteration() {
+            if (iteration == std::numeric_limits<uint16_t>::max()) {
+                std::fill(entries.begin(), entries.end(), TranspositionEntry{0, 0, 0, false});
+                iteration = 0;
+            }
+            iteration++;
+            used = 0;
+            cut_entries = 0;
+            lossy = false;
+        }
+        bool exhausted() const { return enabled() && !lossy && cut_entries == 0; }
+        // True when the state was already reached this iteration at the same or a smaller depth
+        bool visit(uint64_t key, uint16_t g, bool cut) {
+            if (used * 2 >= entries.size() && entries.size() < max_size) {
+                grow();
+            }
+            TranspositionEntry* entry = find(key);
+            if (entry && entry->iteration == iteration) {
+                if (entry->g <= g) {
+                    return true;
+                }
+                // A shallower path has a smaller f, so it can only lift the cut
+                if (entry->cut && !cut) {
+                    cut_entries--;
                 }
-                return {path, path.size() - 1, states_explored, elapsed_time.count()};
+                entry->g = g;
+                entry->cut = cut;
+                return false;
+            }
+            if (entry) {
+                used++;
+            } else {
+                // Full window at the size limit: evict the entry in the state's home slot
+                entry = &entries[key & (entries.size() - 1)];
+                lossy = true;
+                cut_entries -= entry->cut;
+            }
+            *entry = {key, g, iteration, cut};
+            if (cut) {
+                cut_entries++;
+            }
+            return false;
+        }
+    };
+
+    struct IdaSearch {
+        const Algorithms& solver;
+        const PieceTable& table;
+        SolverObserver& observer;
+        BudgetGuard& guard;
+        TranspositionTable transpositions;
+        State state;
+        std::vector<Move> path;
+        std::vector<uint64_t> path_hashes;
+        std::deque<std::vector<Move>> move_buffers;
+        double bound = 0.0;
+        double next_bound = 0.0;
+        int states_explored = 0;
+        SearchStats stats{};
+        std::vector<Move> best_path{};   // Route to the state closest to the exit so far, for interrupted searches
+        int best_distance = std::numeric_limits<int>::max();
+
+        // False both when the subtree holds no goal and when the guard stopped the search
+        bool search(int g) {
+            if (guard.exceeded(states_explored, [&] { return transpositions.memory_usage() + path.capacity() * sizeof(Move); })) {
+                return false;
+            }
+            states_explored++;
+            int distance = Algorithms::progress(table, state);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best_path = path;
+            }
+            observer.on_expand(table, state);
+            stats.open_size(path.size());
+            if (table.is_goal(state)) {
+                return true;
+            }
+            double f = g + stats.timed(SearchStats::HEURISTIC, [&] { return solver.heuristic(table, state); });
+            bool cut = f > bound;
+            if (transpositions.enabled() &&
+                stats.timed(SearchStats::HASHING, [&] { return transpositions.visit(state.hash, static_cast<uint16_t>(g), cut); })) {
+                stats.duplicate();
+                return false;
+            }
+            if (cut) {
+                next_bound = std::min(next_bound, f);
+                return false;
             }
-            double f_score = g_score[current] + heuristic(current);
-            if (f_score > bound) {
-                next_bound = std::min(next_bound, f_score);
-                continue;
+            if (move_buffers.size() <= static_cast<size_t>(g)) {
+                move_buffers.emplace_back();
             }
-            for (const auto& next : current.get_possible_steps()) {
-                double new_cost = g_score[current] + 1.0;
-                
-                if (g_score.find(next) == g_score.end() || new_cost < g_score[next]) {
-                    g_score[next] = new_cost;
-                    from[next] = current;
-                    dfs_stack.push({next, new_cost});
+            std::vector<Move>& moves = move_buffers[g];
+            stats.timed(SearchStats::EXPANSION, [&] { table.get_moves(state, moves); });
+            stats.generated(moves.size());
+            for (const auto& move : moves) {
+                // Sliding the piece that just moved again is never shorter than one combined slide
+                if (!path.empty() && path.back().piece == move.piece) {
+                    continue;
                 }
+                table.apply_move(state, move);
+                if (std::find(path_hashes.begin(), path_hashes.end(), state.hash) != path_hashes.end()) {
+                    table.undo_move(state, move);
+                    stats.duplicate();
+                    continue;
+                }
+                path.push_back(move);
+                path_hashes.push_back(state.hash);
+                if (search(g + 1)) {
+                    return true;
+                }
+                if (guard.stopped()) {
+                    return false;
+                }
+                path.pop_back();
+                path_hashes.pop_back();
+                table.undo_move(state, move);
             }
+            return false;
         }
-        if (next_bound == std::numeric_limits<double>::infinity()) {
+    };
+}
+
+Algorithms::Result IDA::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    prepare_heuristic(*table, start);
+    IdaSearch search{*this, *table, *observer, guard, TranspositionTable(table_megabytes), start, {}, {start.hash}, {}};
+    search.bound = heuristic(*table, start);
+    while (true) {
+        search.next_bound = std::numeric_limits<double>::infinity();
+        search.transpositions.next_iteration();
+        if (search.search(0)) {
+            auto end_time = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed_time = end_time - start_time;
+            std::vector<Steps> path = {Steps(table, start)};
+            State replay = start;
+            for (const auto& move : search.path) {
+                table->apply_move(replay, move);
+                path.emplace_back(table, replay);
+            }
+            return finish({path, static_cast<int>(path.size()) - 1, search.states_explored, elapsed_time.count()}, search.stats);
+        }
+        if (guard.stopped()) {
+            auto end_time = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed_time = end_time - start_time;
+            Result result = {{}, 0, search.states_explored, elapsed_time.count()};
+            result.status = guard.get_status();
+            result.partial_path = {Steps(table, start)};
+            State replay = start;
+            for (const auto& move : search.best_path) {
+                table->apply_move(replay, move);
+                result.partial_path.emplace_back(table, replay);
+            }
+            return finish(result, search.stats);
+        }
+        if (search.next_bound == std::numeric_limits<double>::infinity() || search.transpositions.exhausted()) {
             // No solution exists
             auto end_time = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> elapsed_time = end_time - start_time;
-            return {{}, 0, states_explored, elapsed_time.count()};
+            return finish({{}, 0, search.states_explored, elapsed_time.count()}, search.stats);
         }
-        bound = next_bound;
+        search.bound = search.next_bound;
     }
-}
\ No newline at end of file
+}
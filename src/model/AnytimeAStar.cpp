@@ -0,0 +1,167 @@
+#include "Algorithms.hpp"
+#include <cmath>
+
+Algorithms::Result AnytimeAStar::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
+    int states_explored = 0;
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    prepare_heuristic(*table, start);
+    if (table->is_goal(start)) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed_time = end_time - start_time;
+        return {{Steps(table, start)}, 0, 1, elapsed_time.count()};
+    }
+    SearchStats stats;
+    NodeArena arena;
+    std::vector<double> h_values;       // Heuristic of every arena node, so keys can be recomputed for a new weight
+    std::vector<uint32_t> inconsistent; // Improved after being closed in the current iteration
+    std::vector<char> is_inconsistent;
+    std::vector<std::pair<double, uint32_t>> open;  // Binary heap of (g + w*h, node) with stale entries skipped on pop
+    auto later = [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) { return a.first > b.first; };
+    std::vector<Move> moves;
+    double weight = std::max(1.0, initial_weight);
+    auto key = [&](uint32_t id) { return arena[id].g + weight * h_values[id]; };
+    auto push = [&](uint32_t id) {
+        open.push_back({key(id), id});
+        std::push_heap(open.begin(), open.end(), later);
+    };
+    uint32_t root = arena.insert(start, NO_PARENT, {}, 0.0).first;
+    h_values.push_back(heuristic(*table, start));
+    is_inconsistent.push_back(0);
+    push(root);
+
+    double best_cost = std::numeric_limits<double>::infinity();
+    std::vector<Steps> best_path;
+    int solutions = 0;
+    double bound = std::numeric_limits<double>::infinity();
+    // Lowest g + h over every node that could still lead to a shorter path
+    auto lower_bound = [&] {
+        double lowest = best_cost;
+        for (const auto& [f, id] : open) {
+            if (!arena[id].closed) {
+                lowest = std::min(lowest, arena[id].g + h_values[id]);
+            }
+        }
+        for (uint32_t id : inconsistent) {
+            lowest = std::min(lowest, arena[id].g + h_values[id]);
+        }
+        return lowest;
+    };
+    while (true) {
+        bool improved = false;
+        // Expand in order of g + w*h until no open node can beat the incumbent
+        while (!open.empty()) {
+            auto [f, current] = open.front();
+            if (arena[current].closed || f != key(current)) {
+                std::pop_heap(open.begin(), open.end(), later);
+                open.pop_back();
+                continue;
+            }
+            if (f >= best_cost) {
+                break;
+            }
+            if (guard.exceeded(states_explored, [&] { return arena.memory_usage() + open.capacity() * sizeof(open[0]); })) {
+                break;
+            }
+            stats.timed(SearchStats::QUEUE, [&] {
+                std::pop_heap(open.begin(), open.end(), later);
+                open.pop_back();
+            });
+            states_explored++;
+            State state = arena[current].state;
+            observer->on_expand(*table, state);
+            arena[current].closed = true;
+            stats.closed();
+            double current_g_score = arena[current].g;
+            if (table->is_goal(state)) {
+                if (current_g_score < best_cost) {
+                    best_cost = current_g_score;
+                    best_path = get_path(table, arena, current);
+                    improved = true;
+                }
+                continue;
+            }
+            stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+            stats.generated(moves.size());
+            for (const auto& move : moves) {
+                State next = state;
+                table->apply_move(next, move);
+                double tentative_g_score = current_g_score + 1.0;
+                auto [id, inserted] = stats.timed(SearchStats::HASHING, [&] { return arena.insert(next, current, move, tentative_g_score); });
+                if (inserted) {
+                    h_values.push_back(stats.timed(SearchStats::HEURISTIC, [&] { return heuristic(*table, next); }));
+                    is_inconsistent.push_back(0);
+                } else {
+                    Node& node = arena[id];
+                    if (tentative_g_score >= node.g) {
+                        stats.duplicate();
+                        continue;
+                    }
+                    node.parent = current;
+                    node.move = move;
+                    node.g = tentative_g_score;
+                    if (node.closed) {
+                        // Left for the next iteration rather than re-expanded now, as ARA* does
+                        if (!is_inconsistent[id]) {
+                            is_inconsistent[id] = 1;
+                            inconsistent.push_back(id);
+                            stats.reopened();
+                        }
+                        continue;
+                    }
+                    stats.updated();
+                }
+                stats.timed(SearchStats::QUEUE, [&] { push(id); });
+            }
+            stats.open_size(open.size());
+        }
+        if (!best_path.empty()) {
+            double lowest = lower_bound();
+            double proven = lowest > 0.0 ? std::max(1.0, best_cost / lowest) : weight;
+            // A completed iteration also guarantees the weight itself
+            double current_bound = guard.stopped() ? proven : std::min(weight, proven);
+            if (improved || current_bound < bound) {
+                bound = current_bound;
+                solutions += improved ? 1 : 0;
+                observer->on_solution(static_cast<int>(best_path.size()) - 1, bound);
+            }
+        }
+        if (guard.stopped() || weight <= 1.0) {
+            break;
+        }
+        // Lower the weight, fold the inconsistent nodes back in and reorder the open list by the new keys
+        weight = std::max(1.0, weight - weight_step);
+        std::vector<uint32_t> reopen;
+        for (const auto& [f, id] : open) {
+            if (!arena[id].closed && !is_inconsistent[id]) {
+                is_inconsistent[id] = 1;
+                reopen.push_back(id);
+            }
+        }
+        reopen.insert(reopen.end(), inconsistent.begin(), inconsistent.end());
+        inconsistent.clear();
+        open.clear();
+        for (uint32_t id = 0; id < arena.size(); ++id) {
+            arena[id].closed = false;
+        }
+        for (uint32_t id : reopen) {
+            is_inconsistent[id] = 0;
+            push(id);
+        }
+    }
+    report_hash_stats(*table, arena);
+    stats.memory(arena.memory_usage() + h_values.capacity() * sizeof(double), arena.size());
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    std::vector<std::pair<std::string, long long>> extra_stats = {
+        {"Solutions found", solutions},
+        {"Final weight (x100)", std::llround(weight * 100)},
+    };
+    if (!best_path.empty()) {
+        extra_stats.push_back({"Suboptimality bound (x1000)", std::llround(bound * 1000)});
+    }
+    int move_count = best_path.empty() ? 0 : static_cast<int>(best_path.size()) - 1;
+    return finish(interrupted({best_path, move_count, states_explored, elapsed_time.count(), extra_stats}, guard, table, arena), stats);
+}
@@ -0,0 +1,143 @@
+#include "Algorithms.hpp"
+
+namespace {
+    struct BeamLink {
+        uint32_t parent;    // Index into the previous layer
+        Move move;
+    };
+
+    struct BeamCandidate {
+        State state;
+        double h;
+        BeamLink link;
+    };
+}
+
+Algorithms::Result BeamSearch::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    prepare_heuristic(*table, start);
+    if (table->is_goal(start)) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed_time = end_time - start_time;
+        return {{Steps(table, start)}, 0, 1, elapsed_time.count()};
+    }
+    size_t beam_width = std::max<size_t>(1, width);
+    SearchStats stats;
+    // Only the links of every layer are kept; full states exist for the current beam alone
+    std::vector<std::vector<BeamLink>> links = {{{NO_PARENT, {}}}};
+    std::vector<State> beam = {start};
+    std::unordered_set<State> previous_states;
+    std::unordered_set<State> beam_states = {start};
+    std::unordered_set<State> seen;
+    std::vector<BeamCandidate> candidates;
+    std::vector<Move> moves;
+    int states_explored = 0;
+    int goal_layer = -1;
+    BeamLink goal_link{NO_PARENT, {}};
+    uint32_t closest = 0;   // Beam slot nearest the exit, for interrupted searches
+    auto memory = [&] {
+        size_t link_count = 0;
+        for (const auto& layer : links) {
+            link_count += layer.capacity();
+        }
+        return link_count * sizeof(BeamLink) + candidates.capacity() * sizeof(BeamCandidate) +
+               (beam.capacity() + previous_states.size() + beam_states.size() + seen.size()) * sizeof(State);
+    };
+    while (goal_layer == -1 && !beam.empty() && links.size() <= max_depth) {
+        candidates.clear();
+        seen.clear();
+        for (uint32_t slot = 0; slot < beam.size() && goal_layer == -1; ++slot) {
+            if (guard.exceeded(states_explored, memory)) {
+                break;
+            }
+            State state = beam[slot];
+            states_explored++;
+            stats.closed();
+            observer->on_expand(*table, state);
+            stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+            stats.generated(moves.size());
+            for (const auto& move : moves) {
+                table->apply_move(state, move);
+                // Moves are reversible, so most repeats are one or two layers back
+                bool repeated = stats.timed(SearchStats::HASHING, [&] {
+                    return beam_states.count(state) > 0 || previous_states.count(state) > 0 || !seen.insert(state).second;
+                });
+                if (repeated) {
+                    stats.duplicate();
+                } else if (table->is_goal(state)) {
+                    goal_layer = static_cast<int>(links.size());
+                    goal_link = {slot, move};
+                    break;
+                } else {
+                    double h = stats.timed(SearchStats::HEURISTIC, [&] { return heuristic(*table, state); });
+                    candidates.push_back({state, h, {slot, move}});
+                }
+                table->undo_move(state, move);
+            }
+        }
+        if (goal_layer != -1 || guard.stopped()) {
+            break;
+        }
+        // Keep the best width candidates without sorting the rest
+        stats.timed(SearchStats::QUEUE, [&] {
+            if (candidates.size() > beam_width) {
+                std::nth_element(candidates.begin(), candidates.begin() + beam_width, candidates.end(),
+                                 [](const BeamCandidate& a, const BeamCandidate& b) { return a.h < b.h; });
+                candidates.resize(beam_width);
+            }
+        });
+        stats.open_size(candidates.size());
+        previous_states.swap(beam_states);
+        beam_states.clear();
+        beam.clear();
+        links.emplace_back();
+        closest = 0;
+        int closest_distance = std::numeric_limits<int>::max();
+        for (const auto& candidate : candidates) {
+            int distance = progress(*table, candidate.state);
+            if (distance < closest_distance) {
+                closest_distance = distance;
+                closest = static_cast<uint32_t>(beam.size());
+            }
+            beam.push_back(candidate.state);
+            beam_states.insert(candidate.state);
+            links.back().push_back(candidate.link);
+        }
+    }
+    stats.memory(memory(), beam.size());
+
+    // Replays the moves from the start down to one slot of the given layer
+    auto trace = [&](int layer, BeamLink last) {
+        std::vector<Move> path_moves = {last.move};
+        for (uint32_t slot = last.parent; layer-- > 1; slot = links[layer][slot].parent) {
+            path_moves.push_back(links[layer][slot].move);
+        }
+        std::reverse(path_moves.begin(), path_moves.end());
+        std::vector<Steps> path = {Steps(table, start)};
+        State state = start;
+        for (const auto& move : path_moves) {
+            table->apply_move(state, move);
+            path.emplace_back(table, state);
+        }
+        return path;
+    };
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    std::vector<std::pair<std::string, long long>> extra_stats = {
+        {"Beam width", static_cast<long long>(beam_width)},
+        {"Layers", static_cast<long long>(links.size())},
+    };
+    Result result = {{}, 0, states_explored, elapsed_time.count(), extra_stats};
+    if (goal_layer != -1) {
+        result.path = trace(goal_layer, goal_link);
+        result.move_count = static_cast<int>(result.path.size()) - 1;
+    } else if (guard.stopped()) {
+        result.status = guard.get_status();
+        int layer = static_cast<int>(links.size()) - 1;
+        result.partial_path = layer == 0 ? std::vector<Steps>{Steps(table, start)} : trace(layer, links[layer][closest]);
+    }
+    return finish(result, stats);
+}
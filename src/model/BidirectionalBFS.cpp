@@ -0,0 +1,112 @@
+#include "Algorithms.hpp"
+
+Algorithms::Result BidirectionalBFS::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    if (table->is_goal(start)) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed_time = end_time - start_time;
+        return {{Steps(table, start)}, 0, 1, elapsed_time.count()};
+    }
+    NodeArena forward;
+    NodeArena backward;
+    std::vector<uint32_t> forward_layer = {forward.insert(start, NO_PARENT, {}, 0.0).first};
+    std::vector<uint32_t> backward_layer;
+    std::vector<uint32_t> next_layer;
+    std::vector<State> goals;
+    bool bidirectional = table->enumerate_goals(start, goals, goal_limit);
+    if (bidirectional) {
+        for (const auto& goal : goals) {
+            auto [id, inserted] = backward.insert(goal, NO_PARENT, {}, 0.0);
+            if (inserted) {
+                backward_layer.push_back(id);
+            }
+        }
+    }
+    long long goal_count = static_cast<long long>(goals.size());
+    goals.clear();
+    goals.shrink_to_fit();
+
+    SearchStats stats;
+    int forward_explored = 0;
+    int backward_explored = 0;
+    uint32_t meet_forward = NO_PARENT;
+    uint32_t meet_backward = NO_PARENT;
+    double best_length = std::numeric_limits<double>::infinity();
+    std::vector<Move> moves;
+    while (meet_forward == NO_PARENT && !guard.stopped() && !forward_layer.empty() && (!bidirectional || !backward_layer.empty())) {
+        bool expand_forward = !bidirectional || forward_layer.size() <= backward_layer.size();
+        NodeArena& own = expand_forward ? forward : backward;
+        NodeArena& other = expand_forward ? backward : forward;
+        std::vector<uint32_t>& layer = expand_forward ? forward_layer : backward_layer;
+        int& explored = expand_forward ? forward_explored : backward_explored;
+        next_layer.clear();
+        // The whole layer is expanded even after a meeting, so the shortest of its meetings is optimal
+        for (uint32_t current : layer) {
+            if (guard.exceeded(forward_explored + backward_explored, [&] { return forward.memory_usage() + backward.memory_usage(); })) {
+                break;
+            }
+            explored++;
+            stats.closed();
+            State state = own[current].state;
+            double g = own[current].g;
+            observer->on_expand(*table, state);
+            stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+            stats.generated(moves.size());
+            for (const auto& move : moves) {
+                State next = state;
+                table->apply_move(next, move);
+                auto [id, inserted] = stats.timed(SearchStats::HASHING, [&] { return own.insert(next, current, move, g + 1.0); });
+                if (!inserted) {
+                    stats.duplicate();
+                    continue;
+                }
+                next_layer.push_back(id);
+                double length;
+                uint32_t match;
+                if (bidirectional) {
+                    match = stats.timed(SearchStats::HASHING, [&] { return other.find(next); });
+                    if (match == NO_PARENT) {
+                        continue;
+                    }
+                    length = g + 1.0 + other[match].g;
+                } else {
+                    if (!table->is_goal(next)) {
+                        continue;
+                    }
+                    match = NO_PARENT;
+                    length = g + 1.0;
+                }
+                if (length < best_length) {
+                    best_length = length;
+                    meet_forward = expand_forward ? id : match;
+                    meet_backward = expand_forward ? match : id;
+                }
+            }
+        }
+        layer.swap(next_layer);
+        stats.open_size(forward_layer.size() + backward_layer.size());
+    }
+    stats.memory(forward.memory_usage() + backward.memory_usage(), forward.size() + backward.size());
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    std::vector<std::pair<std::string, long long>> extra_stats = {
+        {"Forward states explored", forward_explored},
+        {"Backward states explored", backward_explored},
+        {"Goal layouts seeded", bidirectional ? goal_count : 0},
+    };
+    // An interrupted layer may hold a meeting, but not necessarily the shortest one
+    if (guard.stopped() || meet_forward == NO_PARENT) {
+        return finish(interrupted({{}, 0, forward_explored + backward_explored, elapsed_time.count(), extra_stats}, guard, table, forward), stats);
+    }
+    std::vector<Steps> path = get_path(table, forward, meet_forward);
+    if (meet_backward != NO_PARENT) {
+        for (uint32_t i = backward[meet_backward].parent; i != NO_PARENT; i = backward[i].parent) {
+            path.emplace_back(table, backward[i].state);
+        }
+    }
+    return finish({path, static_cast<int>(path.size()) - 1, forward_explored + backward_explored, elapsed_time.count(), extra_stats}, stats);
+}
@@ -1,15 +1,13 @@
 #include "Board.hpp"
 
-void Board::update_cell(std::shared_ptr<Piece> piece) {
-    auto positions = piece->get_positions();
-    for (auto const& i : positions){
+void Board::update_cell(const std::shared_ptr<Piece>& piece) {
+    for (auto const& i : piece->get_positions()){
         grid[i.row][i.col]->set_piece(piece);
     }
 }
 
-void Board::clear_cell(std::shared_ptr<Piece> piece) {
-    auto positions = piece->get_positions();
-    for (auto const& i : positions){
+void Board::clear_cell(const std::shared_ptr<Piece>& piece) {
+    for (auto const& i : piece->get_positions()){
         grid[i.row][i.col]->set_piece(nullptr);
     }
 }
@@ -104,13 +102,44 @@ void Board::move_piece(std::string piece_id, Position new_head) {
     if (!is_valid_pos(new_head)) {
         throw InvalidPositionException("Invalid position at move_piece" + std::to_string(new_head.row) + " " + std::to_string(new_head.col) + "Piece: " + piece->get_id());
     }
-    auto positions = piece->get_positions();
-    if (!is_valid_piece(piece, new_head)) {
+    if (!can_move_piece(piece, new_head)) {
         throw InvalidMoveException("Invalid move");
     }
+    apply_move(piece, new_head);
+}
+
+bool Board::can_move_piece(const std::shared_ptr<Piece>& piece, Position new_head) const noexcept {
+    if (!piece->can_move(new_head)) {
+        return false;
+    }
+    int d_row = piece->get_orientation() == Orientation::VERTICAL ? 1 : 0;
+    int d_col = 1 - d_row;
+    for (int i = 0; i < piece->get_length(); ++i) {
+        Position pos(new_head.row + i * d_row, new_head.col + i * d_col);
+        if (!is_valid_pos(pos)) {
+            return false;
+        }
+        const auto& occupant = grid[pos.row][pos.col]->get_piece();
+        if (occupant && occupant != piece) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Callers are expected to check can_move_piece first; no validation happens here.
+BoardMove Board::apply_move(const std::shared_ptr<Piece>& piece, Position new_head) {
+    BoardMove move{piece, piece->get_head(), new_head};
     clear_cell(piece);
     piece->move(new_head);
-    add_piece(piece);
+    update_cell(piece);
+    return move;
+}
+
+void Board::undo_move(const BoardMove& move) {
+    clear_cell(move.piece);
+    move.piece->move(move.from);
+    update_cell(move.piece);
 }
 
 bool Board::is_valid_pos(Position pos) const {
@@ -0,0 +1,62 @@
+#include "BucketQueue.hpp"
+#include <cmath>
+#include <string>
+
+void BucketQueue::push(size_t f, size_t h, uint32_t handle) {
+    if (f >= buckets.size()) {
+        buckets.resize(f + 1);
+    }
+    FBucket& bucket = buckets[f];
+    if (h >= bucket.by_h.size()) {
+        bucket.by_h.resize(h + 1);
+    }
+    bucket.by_h[h].push_back(handle);
+    if (bucket.count == 0 || h < bucket.min_h) {
+        bucket.min_h = h;
+    }
+    bucket.count++;
+    if (count == 0 || f < min_f) {
+        min_f = f;
+    }
+    count++;
+}
+
+// Callers check empty() first
+uint32_t BucketQueue::pop() {
+    while (buckets[min_f].count == 0) {
+        min_f++;
+    }
+    FBucket& bucket = buckets[min_f];
+    while (bucket.by_h[bucket.min_h].empty()) {
+        bucket.min_h++;
+    }
+    std::vector<uint32_t>& entries = bucket.by_h[bucket.min_h];
+    uint32_t handle = entries.back();
+    entries.pop_back();
+    bucket.count--;
+    count--;
+    return handle;
+}
+
+void BucketQueue::clear() {
+    buckets.clear();
+    min_f = 0;
+    count = 0;
+}
+
+// Scaled key as a bucket index, rejecting what a cast to size_t would silently turn into garbage
+namespace {
+size_t bucket_key(const char* name, double value, int scale) {
+    double scaled = value * scale;
+    double rounded = std::round(scaled);
+    if (!(rounded >= 0.0) || std::abs(scaled - rounded) > 1e-9) {
+        throw OpenListException(std::string("Open list key ") + name + " = " + std::to_string(value) +
+                                " is not a non-negative multiple of 1/" + std::to_string(scale));
+    }
+    return static_cast<size_t>(rounded);
+}
+}
+
+void OpenList::push(double f, double h, uint32_t handle) {
+    buckets.push(bucket_key("f", f, scale), bucket_key("h", h, scale), handle);
+}
@@ -0,0 +1,194 @@
+#include "Corpus.hpp"
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    bool is_blank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // Splits off the next whitespace-separated field of text
+    std::string_view next_field(std::string_view& text) {
+        size_t begin = 0;
+        while (begin < text.size() && is_blank(text[begin])) {
+            begin++;
+        }
+        size_t end = begin;
+        while (end < text.size() && !is_blank(text[end])) {
+            end++;
+        }
+        std::string_view field = text.substr(begin, end - begin);
+        text.remove_prefix(end);
+        return field;
+    }
+
+    bool parse_int(std::string_view field, int& value) {
+        auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+        return error == std::errc() && end == field.data() + field.size();
+    }
+}
+
+CorpusReader::CorpusReader(const std::string& path) : path(path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw CorpusException("Could not open corpus: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        throw CorpusException("Empty corpus: " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw CorpusException("Could not map corpus: " + path);
+    }
+    data = static_cast<const char*>(mapped);
+    ::madvise(mapped, length, MADV_SEQUENTIAL);
+
+    std::string_view header;
+    std::string_view rows_field;
+    std::string_view cols_field;
+    std::string_view primary_field;
+    bool valid = next_line(header);
+    if (valid) {
+        rows_field = next_field(header);
+        cols_field = next_field(header);
+        primary_field = next_field(header);
+        valid = parse_int(rows_field, rows) && parse_int(cols_field, cols) && rows > 0 && cols > 0 &&
+                primary_field.size() <= 1 && next_field(header).empty();
+    }
+    if (!valid) {
+        ::munmap(const_cast<char*>(data), length);
+        throw CorpusException("Corpus header must be \"<rows> <cols> [primary]\": " + path);
+    }
+    if (!primary_field.empty()) {
+        primary = primary_field[0];
+    }
+}
+
+CorpusReader::~CorpusReader() {
+    if (data) {
+        ::munmap(const_cast<char*>(data), length);
+    }
+}
+
+// The next line that is neither blank nor a comment, without its line break
+bool CorpusReader::next_line(std::string_view& text) {
+    while (position < length) {
+        const char* begin = data + position;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', length - position));
+        size_t size = newline ? static_cast<size_t>(newline - begin) : length - position;
+        position += size + 1;
+        line++;
+        text = std::string_view(begin, size);
+        size_t first = 0;
+        while (first < text.size() && is_blank(text[first])) {
+            first++;
+        }
+        if (first < text.size() && text[first] != '#') {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CorpusReader::next(CorpusPuzzle& puzzle) {
+    std::string_view text;
+    if (!next_line(text)) {
+        return false;
+    }
+    size_t cell_count = static_cast<size_t>(rows) * cols;
+    puzzle = CorpusPuzzle();
+    puzzle.line = line;
+    for (std::string_view field = next_field(text); !field.empty(); field = next_field(text)) {
+        if (field.size() == cell_count) {
+            puzzle.cells = field;
+            break;
+        }
+        if (puzzle.moves != -1 || !parse_int(field, puzzle.moves)) {
+            break;
+        }
+    }
+    return true;
+}
+
+Board CorpusReader::make_board(const CorpusPuzzle& puzzle) const {
+    struct Extent {
+        int count = 0;
+        int min_row = 0;
+        int min_col = 0;
+        int max_row = 0;
+        int max_col = 0;
+    };
+    std::array<Extent, 256> extents{};
+    std::string where = path + ":" + std::to_string(puzzle.line) + ": ";
+    if (puzzle.cells.size() != static_cast<size_t>(rows) * cols) {
+        throw CorpusException(where + "expected " + std::to_string(rows * cols) + " cells");
+    }
+    for (int cell = 0; cell < rows * cols; ++cell) {
+        unsigned char c = static_cast<unsigned char>(puzzle.cells[cell]);
+        if (c == '.' || c == 'o') {
+            continue;
+        }
+        if (c == 'x') {
+            throw CorpusException(where + "walls are not supported");
+        }
+        if (!std::isalpha(c)) {
+            throw CorpusException(where + "unexpected cell '" + std::string(1, static_cast<char>(c)) + "'");
+        }
+        int row = cell / cols;
+        int col = cell % cols;
+        Extent& extent = extents[c];
+        if (extent.count++ == 0) {
+            extent = {1, row, col, row, col};
+        } else {
+            extent.min_row = std::min(extent.min_row, row);
+            extent.min_col = std::min(extent.min_col, col);
+            extent.max_row = std::max(extent.max_row, row);
+            extent.max_col = std::max(extent.max_col, col);
+        }
+    }
+    const Extent& primary_extent = extents[static_cast<unsigned char>(primary)];
+    if (primary_extent.count == 0) {
+        throw CorpusException(where + "primary car '" + std::string(1, primary) + "' not found");
+    }
+    Position goal = primary_extent.min_row == primary_extent.max_row && primary_extent.count > 1
+                        ? Position(primary_extent.min_row, cols - 1)
+                        : Position(rows - 1, primary_extent.min_col);
+    Board board(rows, cols, goal);
+    for (int c = 0; c < 256; ++c) {
+        const Extent& extent = extents[c];
+        if (extent.count == 0) {
+            continue;
+        }
+        Orientation orientation;
+        if (extent.min_row == extent.max_row && extent.max_col - extent.min_col + 1 == extent.count) {
+            orientation = Orientation::HORIZONTAL;
+        } else if (extent.min_col == extent.max_col && extent.max_row - extent.min_row + 1 == extent.count) {
+            orientation = Orientation::VERTICAL;
+        } else {
+            throw CorpusException(where + "piece '" + std::string(1, static_cast<char>(c)) + "' is not a straight line of cells");
+        }
+        Position head(extent.min_row, extent.min_col);
+        char id = static_cast<char>(c);
+        try {
+            if (id == primary) {
+                board.add_piece(std::make_shared<Primary>(extent.count, head, orientation));
+            } else {
+                // The solvers know the primary car as "P", so a secondary 'P' takes the primary's letter
+                board.add_piece(std::make_shared<Secondary>(std::string(1, id == 'P' ? primary : id), extent.count, head, orientation));
+            }
+        } catch (const std::exception& e) {
+            throw CorpusException(where + "invalid piece '" + std::string(1, id) + "': " + e.what());
+        }
+    }
+    return board;
+}
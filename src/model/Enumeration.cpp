@@ -0,0 +1,432 @@
+#include "Enumeration.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include "Corpus.hpp"
+#include "State.hpp"
+#include "WorkQueue.hpp"
+
+namespace {
+    constexpr char MAGIC[8] = {'R', 'H', 'E', 'N', 'U', 'M', '\0', '\0'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    constexpr uint16_t UNREACHED = 0xFFFF;
+
+    // Every sequence of cars and trucks that fits in a lane of this size, fewest pieces first
+    std::vector<std::vector<int>> lane_contents(int size) {
+        std::vector<std::vector<int>> contents = {{}};
+        std::vector<int> used = {0};
+        for (size_t i = 0; i < contents.size(); ++i) {
+            for (int length : {2, 3}) {
+                if (used[i] + length <= size) {
+                    contents.push_back(contents[i]);
+                    contents.back().push_back(length);
+                    used.push_back(used[i] + length);
+                }
+            }
+        }
+        return contents;
+    }
+
+    // Contents of the exit row: a lane_contents entry and which of its two-cell pieces is the primary car
+    struct ExitContents {
+        int contents;
+        size_t primary;
+    };
+
+    struct Slot {
+        bool horizontal;
+        int lane;
+        int length;
+        bool follows;               // Shares its lane with the previous slot, so must stay after it
+        std::vector<uint64_t> masks;    // Cells covered at every offset
+    };
+
+    template<typename T>
+    void append(std::string& out, T value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    bool extract(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+}
+
+LayoutEnumerator::LayoutEnumerator(const EnumerationOptions& options) : options(options), exit_row((options.rows - 1) / 2) {
+    if (options.rows < 1 || options.cols < 3 || options.rows * options.cols > 64) {
+        throw EnumerationException("Board size out of range: " + std::to_string(options.rows) + "x" + std::to_string(options.cols));
+    }
+    if (options.max_pieces < 1 || options.max_pieces > std::min<int>(MAX_PIECES, static_cast<int>(CORPUS_LABELS.size()) + 1)) {
+        throw EnumerationException("Piece limit out of range: " + std::to_string(options.max_pieces));
+    }
+}
+
+EnumerationSummary LayoutEnumerator::run(const std::string& path) const {
+    int rows = options.rows;
+    int cols = options.cols;
+    std::vector<std::vector<int>> row_options = lane_contents(cols);
+    std::vector<std::vector<int>> col_options = lane_contents(rows);
+    // Pieces to the right of the primary car keep it from the exit, but their layouts are legal too
+    std::vector<ExitContents> exit_options;
+    for (size_t i = 0; i < row_options.size(); ++i) {
+        for (size_t k = 0; k < row_options[i].size(); ++k) {
+            if (row_options[i][k] == 2) {
+                exit_options.push_back({static_cast<int>(i), k});
+            }
+        }
+    }
+    auto row_contents = [&](const std::vector<int>& choice, int row) -> const std::vector<int>& {
+        return row_options[row == exit_row ? exit_options[choice[row]].contents : choice[row]];
+    };
+    // Reflecting the board top to bottom keeps the exit row only when it is the middle one
+    bool symmetric = rows - 1 - exit_row == exit_row;
+    std::vector<int> reversed(col_options.size());
+    for (size_t i = 0; i < col_options.size(); ++i) {
+        std::vector<int> flipped(col_options[i].rbegin(), col_options[i].rend());
+        reversed[i] = static_cast<int>(std::find(col_options.begin(), col_options.end(), flipped) - col_options.begin());
+    }
+
+    // One task per choice of row contents within the piece limit; the exit row's entry indexes exit_options
+    std::vector<std::vector<int>> tasks;
+    std::vector<int> rows_choice(rows, 0);
+    std::function<void(int, int)> choose_rows = [&](int row, int pieces) {
+        if (row == rows) {
+            tasks.push_back(rows_choice);
+            return;
+        }
+        size_t option_count = row == exit_row ? exit_options.size() : row_options.size();
+        for (size_t i = 0; i < option_count; ++i) {
+            rows_choice[row] = static_cast<int>(i);
+            int added = static_cast<int>(row_contents(rows_choice, row).size());
+            if (pieces + added <= options.max_pieces) {
+                choose_rows(row + 1, pieces + added);
+            }
+        }
+    };
+    choose_rows(0, 0);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw EnumerationException("Could not open output file: " + path);
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.rows = static_cast<uint8_t>(rows);
+    header.cols = static_cast<uint8_t>(cols);
+    header.exit_row = static_cast<uint8_t>(exit_row);
+    header.max_pieces = static_cast<uint8_t>(options.max_pieces);
+    // Rewritten with the counts once every task is done
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    EnumerationSummary summary;
+    std::mutex output_mutex;
+    std::map<size_t, std::string> finished;     // Records of tasks done ahead of the next one to write
+    size_t next_task = 0;
+
+    auto solve_task = [&](size_t task) {
+        EnumerationSummary local;
+        std::string records;
+        std::vector<int> choice = tasks[task];
+        int row_pieces = 0;
+        for (int row = 0; row < rows; ++row) {
+            row_pieces += static_cast<int>(row_contents(choice, row).size());
+        }
+        std::vector<int> cols_choice(cols, 0);
+        std::vector<Slot> slots;
+        std::vector<int> offsets;
+        std::vector<uint64_t> keys;
+        std::vector<Move> moves;
+
+        // Lists the layouts of one lane assignment and records its solvable components
+        auto solve_assignment = [&]() {
+            slots.clear();
+            auto add_slot = [&](bool horizontal, int lane, int length, bool follows) {
+                Slot slot{horizontal, lane, length, follows, {}};
+                int lane_size = horizontal ? cols : rows;
+                for (int offset = 0; offset + length <= lane_size; ++offset) {
+                    uint64_t mask = 0;
+                    for (int k = 0; k < length; ++k) {
+                        int cell = horizontal ? lane * cols + offset + k : (offset + k) * cols + lane;
+                        mask |= uint64_t(1) << cell;
+                    }
+                    slot.masks.push_back(mask);
+                }
+                slots.push_back(std::move(slot));
+            };
+            int primary_slot = 0;
+            for (int row = 0; row < rows; ++row) {
+                const auto& lengths = row_contents(choice, row);
+                for (size_t k = 0; k < lengths.size(); ++k) {
+                    if (row == exit_row && k == exit_options[choice[row]].primary) {
+                        primary_slot = static_cast<int>(slots.size());
+                    }
+                    add_slot(true, row, lengths[k], k > 0);
+                }
+            }
+            for (int col = 0; col < cols; ++col) {
+                const auto& lengths = col_options[cols_choice[col]];
+                for (size_t k = 0; k < lengths.size(); ++k) {
+                    add_slot(false, col, lengths[k], k > 0);
+                }
+            }
+            int count = static_cast<int>(slots.size());
+
+            // Every legal layout, as offsets in slot order
+            offsets.assign(count, 0);
+            std::vector<uint8_t> layouts;
+            std::function<void(int, uint64_t)> place = [&](int i, uint64_t occupied) {
+                if (i == count) {
+                    layouts.insert(layouts.end(), offsets.begin(), offsets.end());
+                    return;
+                }
+                const Slot& slot = slots[i];
+                int first = slot.follows ? offsets[i - 1] + slots[i - 1].length : 0;
+                for (int offset = first; offset < static_cast<int>(slot.masks.size()); ++offset) {
+                    if (!(slot.masks[offset] & occupied)) {
+                        offsets[i] = offset;
+                        place(i + 1, occupied | slot.masks[offset]);
+                    }
+                }
+            };
+            place(0, 0);
+            if (layouts.empty()) {
+                return;
+            }
+
+            // A board in the first layout gives the PieceTable whose move rules the search uses
+            Board board(rows, cols, Position(exit_row, cols - 1));
+            std::map<std::string, int> slot_of_id;
+            size_t next_label = 0;
+            for (int i = 0; i < count; ++i) {
+                const Slot& slot = slots[i];
+                Position head = slot.horizontal ? Position(slot.lane, layouts[i]) : Position(layouts[i], slot.lane);
+                Orientation orientation = slot.horizontal ? Orientation::HORIZONTAL : Orientation::VERTICAL;
+                std::string id = i == primary_slot ? "P" : std::string(1, CORPUS_LABELS[next_label++]);
+                if (i == primary_slot) {
+                    board.add_piece(std::make_shared<Primary>(slot.length, head, orientation));
+                } else {
+                    board.add_piece(std::make_shared<Secondary>(id, slot.length, head, orientation));
+                }
+                slot_of_id[id] = i;
+            }
+            PieceTable table(board);
+            StateCodec codec(table);
+            if (codec.get_words() != 1) {
+                throw EnumerationException("Layouts with " + std::to_string(count) + " pieces do not pack into 64 bits");
+            }
+            std::vector<int> slot_of_piece(count);
+            for (int j = 0; j < count; ++j) {
+                slot_of_piece[j] = slot_of_id[table.get_pieces()[j].id];
+            }
+            keys.clear();
+            for (size_t start = 0; start < layouts.size(); start += count) {
+                State state;
+                for (int j = 0; j < count; ++j) {
+                    state.offsets[j] = layouts[start + slot_of_piece[j]];
+                }
+                uint64_t key;
+                codec.pack(state, &key);
+                keys.push_back(key);
+            }
+            std::sort(keys.begin(), keys.end());
+            local.lane_assignments++;
+            local.layouts += keys.size();
+
+            // A move rewrites one piece's field of the key, so successors are found without repacking
+            std::vector<int> shift(count);
+            for (int j = 0; j < count; ++j) {
+                State unit;
+                unit.offsets[j] = 1;
+                uint64_t key;
+                codec.pack(unit, &key);
+                while (!((key >> shift[j]) & 1)) {
+                    shift[j]++;
+                }
+            }
+            auto index_of = [&](uint64_t key) {
+                return static_cast<uint32_t>(std::lower_bound(keys.begin(), keys.end(), key) - keys.begin());
+            };
+            std::vector<char> visited(keys.size(), 0);
+            std::vector<uint16_t> distance(keys.size(), UNREACHED);
+            std::vector<uint32_t> members;
+            std::vector<uint32_t> first_edge;   // Successors of members[k] are edges[first_edge[k]..first_edge[k + 1])
+            std::vector<uint32_t> edges;
+            std::vector<uint32_t> position(keys.size());    // Index in members of every layout of the component
+            std::vector<uint32_t> layer;
+            std::vector<uint32_t> next_layer;
+            for (uint32_t seed = 0; seed < keys.size(); ++seed) {
+                if (visited[seed]) {
+                    continue;
+                }
+                // Forward sweep of the component, collecting its goals as the first layer
+                members.assign(1, seed);
+                visited[seed] = 1;
+                first_edge.assign(1, 0);
+                edges.clear();
+                layer.clear();
+                for (size_t k = 0; k < members.size(); ++k) {
+                    uint64_t key = keys[members[k]];
+                    position[members[k]] = static_cast<uint32_t>(k);
+                    State state = codec.unpack(&key);
+                    if (table.is_goal(state)) {
+                        distance[members[k]] = 0;
+                        layer.push_back(members[k]);
+                    }
+                    table.get_moves(state, moves);
+                    for (const auto& move : moves) {
+                        uint32_t next = index_of(key ^ (static_cast<uint64_t>(move.from ^ move.to) << shift[move.piece]));
+                        if (!visited[next]) {
+                            visited[next] = 1;
+                            members.push_back(next);
+                        }
+                        edges.push_back(next);
+                    }
+                    first_edge.push_back(static_cast<uint32_t>(edges.size()));
+                }
+                local.components++;
+                if (layer.empty()) {
+                    continue;
+                }
+                // Backward BFS from every goal at once; moves are reversible so successors double as predecessors
+                int depth = 0;
+                while (true) {
+                    next_layer.clear();
+                    for (uint32_t current : layer) {
+                        uint32_t k = position[current];
+                        for (uint32_t e = first_edge[k]; e < first_edge[k + 1]; ++e) {
+                            if (distance[edges[e]] == UNREACHED) {
+                                distance[edges[e]] = static_cast<uint16_t>(depth + 1);
+                                next_layer.push_back(edges[e]);
+                            }
+                        }
+                    }
+                    if (next_layer.empty()) {
+                        break;
+                    }
+                    layer.swap(next_layer);
+                    depth++;
+                }
+                // The smallest key of the deepest layer, so the record does not depend on the sweep order
+                State hardest = codec.unpack(&keys[*std::min_element(layer.begin(), layer.end())]);
+                std::vector<uint8_t> pieces(count);
+                for (int j = 0; j < count; ++j) {
+                    const PieceInfo& info = table.get_pieces()[j];
+                    Position head = table.get_head(hardest, j);
+                    // Primary car first, then the secondaries in slot order
+                    int slot = slot_of_piece[j];
+                    int index = slot == primary_slot ? 0 : slot < primary_slot ? slot + 1 : slot;
+                    pieces[index] = static_cast<uint8_t>((head.row * cols + head.col) |
+                                                         (info.orientation == Orientation::VERTICAL ? 0x40 : 0) |
+                                                         (info.length == 3 ? 0x80 : 0));
+                }
+                append(records, static_cast<uint16_t>(depth));
+                append(records, static_cast<uint32_t>(members.size()));
+                append(records, static_cast<uint8_t>(count));
+                records.append(reinterpret_cast<const char*>(pieces.data()), pieces.size());
+                local.solvable_components++;
+                local.hardest_moves = std::max(local.hardest_moves, depth);
+            }
+        };
+
+        // Column contents within the remaining piece budget; mirror images of an earlier assignment are skipped
+        std::function<void(int, int)> choose_cols = [&](int col, int pieces) {
+            if (col == cols) {
+                if (symmetric) {
+                    std::vector<int> original = choice;
+                    std::vector<int> mirrored(choice.rbegin(), choice.rend());
+                    original.insert(original.end(), cols_choice.begin(), cols_choice.end());
+                    for (int c : cols_choice) {
+                        mirrored.push_back(reversed[c]);
+                    }
+                    if (mirrored < original) {
+                        return;
+                    }
+                }
+                solve_assignment();
+                return;
+            }
+            for (size_t i = 0; i < col_options.size(); ++i) {
+                if (pieces + static_cast<int>(col_options[i].size()) <= options.max_pieces) {
+                    cols_choice[col] = static_cast<int>(i);
+                    choose_cols(col + 1, pieces + static_cast<int>(col_options[i].size()));
+                }
+            }
+        };
+        choose_cols(0, row_pieces);
+
+        std::lock_guard<std::mutex> lock(output_mutex);
+        summary.lane_assignments += local.lane_assignments;
+        summary.layouts += local.layouts;
+        summary.components += local.components;
+        summary.solvable_components += local.solvable_components;
+        summary.hardest_moves = std::max(summary.hardest_moves, local.hardest_moves);
+        finished[task] = std::move(records);
+        for (auto it = finished.find(next_task); it != finished.end(); it = finished.find(next_task)) {
+            file.write(it->second.data(), it->second.size());
+            finished.erase(it);
+            next_task++;
+        }
+    };
+    int threads = options.threads == 0 ? default_thread_count() : options.threads;
+    run_work_queue(tasks.size(), threads, solve_task);
+
+    header.layout_count = summary.layouts;
+    header.component_count = summary.solvable_components;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!file) {
+        throw EnumerationException("Could not write enumeration: " + path);
+    }
+    return summary;
+}
+
+LayoutEnumerator::FileHeader LayoutEnumerator::read(const std::string& path, const std::function<void(const EnumeratedComponent&)>& visit) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw EnumerationException("Could not open enumeration: " + path);
+    }
+    FileHeader header;
+    if (!extract(file, header) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw EnumerationException("Not an enumeration: " + path);
+    } else if (header.byte_order != BYTE_ORDER_MARK) {
+        throw EnumerationException("Enumeration written with a different byte order: " + path);
+    } else if (header.version != VERSION) {
+        throw EnumerationException("Unsupported enumeration version " + std::to_string(header.version) + ": " + path);
+    }
+    EnumeratedComponent component;
+    for (uint64_t i = 0; i < header.component_count; ++i) {
+        uint16_t moves;
+        uint8_t count;
+        if (!extract(file, moves) || !extract(file, component.size) || !extract(file, count)) {
+            throw EnumerationException("Truncated enumeration: " + path);
+        }
+        component.moves = moves;
+        component.pieces.resize(count);
+        if (!file.read(reinterpret_cast<char*>(component.pieces.data()), count)) {
+            throw EnumerationException("Truncated enumeration: " + path);
+        }
+        visit(component);
+    }
+    return header;
+}
+
+Board LayoutEnumerator::make_board(const FileHeader& header, const EnumeratedComponent& component) {
+    Board board(header.rows, header.cols, Position(header.exit_row, header.cols - 1));
+    for (size_t i = 0; i < component.pieces.size(); ++i) {
+        uint8_t piece = component.pieces[i];
+        int cell = piece & 0x3F;
+        Position head(cell / header.cols, cell % header.cols);
+        Orientation orientation = piece & 0x40 ? Orientation::VERTICAL : Orientation::HORIZONTAL;
+        int length = piece & 0x80 ? 3 : 2;
+        if (i == 0) {
+            board.add_piece(std::make_shared<Primary>(length, head, orientation));
+        } else {
+            board.add_piece(std::make_shared<Secondary>(std::string(1, CORPUS_LABELS[i - 1]), length, head, orientation));
+        }
+    }
+    return board;
+}
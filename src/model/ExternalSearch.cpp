@@ -0,0 +1,424 @@
+#include "ExternalSearch.hpp"
+#include "Algorithms.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr size_t IO_BUFFER_RECORDS = 1 << 13;
+    constexpr size_t MAX_MERGE_FAN_IN = 256;   // Runs merged at once, which bounds the open files
+
+    int compare(const uint64_t* a, const uint64_t* b, int words) {
+        for (int i = 0; i < words; ++i) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // Sequential, buffered reads of a file of fixed-width records
+    class RecordReader {
+    private:
+        std::ifstream file;
+        int words;
+        std::vector<uint64_t> buffer;
+        size_t position = 0;
+        size_t count = 0;
+    public:
+        RecordReader(const fs::path& path, int words) : file(path, std::ios::binary), words(words), buffer(IO_BUFFER_RECORDS * words) {
+            if (!file.is_open()) {
+                throw ExternalSearchException("Could not read " + path.string());
+            }
+        }
+        // The next record, or null at the end of the file; valid until the following call
+        const uint64_t* next() {
+            if (position == count) {
+                file.read(reinterpret_cast<char*>(buffer.data()), buffer.size() * sizeof(uint64_t));
+                count = static_cast<size_t>(file.gcount()) / (words * sizeof(uint64_t));
+                position = 0;
+                if (count == 0) {
+                    return nullptr;
+                }
+            }
+            return &buffer[words * position++];
+        }
+    };
+
+    class RecordWriter {
+    private:
+        fs::path path;
+        std::ofstream file;
+        int words;
+        std::vector<uint64_t> buffer;
+        uint64_t written = 0;
+        void flush() {
+            file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size() * sizeof(uint64_t));
+            buffer.clear();
+            if (!file) {
+                throw ExternalSearchException("Could not write " + path.string());
+            }
+        }
+    public:
+        RecordWriter(const fs::path& path, int words) : path(path), file(path, std::ios::binary | std::ios::trunc), words(words) {
+            if (!file.is_open()) {
+                throw ExternalSearchException("Could not create " + path.string());
+            }
+            buffer.reserve(IO_BUFFER_RECORDS * words);
+        }
+        void put(const uint64_t* record) {
+            buffer.insert(buffer.end(), record, record + words);
+            written++;
+            if (buffer.size() >= IO_BUFFER_RECORDS * words) {
+                flush();
+            }
+        }
+        void close() {
+            flush();
+            file.close();
+        }
+        uint64_t size() const { return written; }
+    };
+
+    // A private directory for one search's files, removed with everything in it when the search ends
+    class ScratchDirectory {
+    private:
+        fs::path path;
+    public:
+        ScratchDirectory(const std::string& parent) {
+            static std::atomic<unsigned> counter{0};
+            std::error_code error;
+            fs::path base = parent.empty() ? fs::temp_directory_path(error) : fs::path(parent);
+            path = base / ("rushhour-external-" + std::to_string(::getpid()) + "-" + std::to_string(counter++));
+            if (!error) {
+                fs::create_directories(path, error);
+            }
+            if (error) {
+                throw ExternalSearchException("Could not create scratch directory " + path.string() + ": " + error.message());
+            }
+        }
+        ScratchDirectory(const ScratchDirectory&) = delete;
+        ScratchDirectory& operator=(const ScratchDirectory&) = delete;
+        ~ScratchDirectory() {
+            std::error_code error;
+            fs::remove_all(path, error);
+        }
+        fs::path file(const std::string& name) const { return path / name; }
+    };
+
+    // Sorts the buffered records and writes each distinct one once; returns how many were written
+    uint64_t write_run(std::vector<uint64_t>& buffer, int words, const fs::path& path, std::vector<uint32_t>& order) {
+        RecordWriter writer(path, words);
+        if (words == 1) {
+            std::sort(buffer.begin(), buffer.end());
+            auto end = std::unique(buffer.begin(), buffer.end());
+            for (auto it = buffer.begin(); it != end; ++it) {
+                writer.put(&*it);
+            }
+        } else {
+            order.resize(buffer.size() / words);
+            for (uint32_t i = 0; i < order.size(); ++i) {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+                return compare(&buffer[a * words], &buffer[b * words], words) < 0;
+            });
+            const uint64_t* previous = nullptr;
+            for (uint32_t i : order) {
+                const uint64_t* record = &buffer[i * words];
+                if (!previous || compare(previous, record, words) != 0) {
+                    writer.put(record);
+                }
+                previous = record;
+            }
+        }
+        writer.close();
+        buffer.clear();
+        return writer.size();
+    }
+
+    // K-way merge of sorted runs, handing every distinct record to emit in order until it returns false
+    void merge_runs(const std::vector<fs::path>& runs, int words, const std::function<bool(const uint64_t*)>& emit) {
+        std::vector<RecordReader> readers;
+        readers.reserve(runs.size());
+        std::vector<const uint64_t*> heads;
+        for (const auto& run : runs) {
+            readers.emplace_back(run, words);
+            heads.push_back(readers.back().next());
+        }
+        auto later = [&](size_t a, size_t b) { return compare(heads[a], heads[b], words) > 0; };
+        std::vector<size_t> heap;
+        for (size_t i = 0; i < heads.size(); ++i) {
+            if (heads[i]) {
+                heap.push_back(i);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), later);
+        std::vector<uint64_t> last(words);
+        bool any = false;
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            size_t i = heap.back();
+            if (!any || compare(last.data(), heads[i], words) != 0) {
+                std::copy(heads[i], heads[i] + words, last.begin());
+                any = true;
+                if (!emit(last.data())) {
+                    return;
+                }
+            }
+            heads[i] = readers[i].next();
+            if (heads[i]) {
+                std::push_heap(heap.begin(), heap.end(), later);
+            } else {
+                heap.pop_back();
+            }
+        }
+    }
+
+    // Binary search of a sorted record file holding count records
+    bool contains(const fs::path& path, const uint64_t* record, int words, uint64_t count) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint64_t> probe(words);
+        uint64_t low = 0;
+        uint64_t high = count;
+        while (low < high) {
+            uint64_t middle = low + (high - low) / 2;
+            file.seekg(static_cast<std::streamoff>(middle * words * sizeof(uint64_t)));
+            if (!file.read(reinterpret_cast<char*>(probe.data()), words * sizeof(uint64_t))) {
+                throw ExternalSearchException("Could not read " + path.string());
+            }
+            int order = compare(probe.data(), record, words);
+            if (order == 0) {
+                return true;
+            }
+            if (order < 0) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return false;
+    }
+}
+
+// Breadth-first search with delayed duplicate detection. Each layer lives in a sorted file; expanding
+// it fills a RAM buffer with successors that is sorted and spilled as a run whenever it reaches the
+// budget. The runs are then merged, and since moves are reversible every successor of layer d lies in
+// layer d-1, d or d+1, so subtracting the two older layer files leaves exactly layer d+1.
+Algorithms::Result ExternalBFS::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    if (table->is_goal(start)) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed_time = end_time - start_time;
+        return {{Steps(table, start)}, 0, 1, elapsed_time.count()};
+    }
+    StateCodec codec(*table);
+    int words = codec.get_words();
+    ScratchDirectory scratch(directory);
+    auto layer_path = [&](size_t depth) { return scratch.file("layer-" + std::to_string(depth)); };
+    size_t capacity = std::max<size_t>(1024, memory_megabytes * (size_t(1) << 20) / (codec.record_bytes() + sizeof(uint32_t)));
+
+    std::vector<uint64_t> record(words);
+    std::vector<uint64_t> layer_sizes;
+    {
+        RecordWriter writer(layer_path(0), words);
+        codec.pack(start, record.data());
+        writer.put(record.data());
+        writer.close();
+        layer_sizes.push_back(writer.size());
+    }
+
+    SearchStats stats;
+    std::vector<uint64_t> buffer;
+    std::vector<uint32_t> order;
+    std::vector<Move> moves;
+    int explored = 0;
+    long long runs_written = 0;
+    uint64_t records_written = 1;
+    uint64_t largest_layer = 1;
+    bool found = false;
+    State goal;
+    State closest = start;      // Expanded state nearest the exit, and its layer, for interrupted searches
+    size_t closest_depth = 0;
+    int closest_distance = progress(*table, start);
+    auto memory = [&] { return buffer.capacity() * sizeof(uint64_t); };
+    while (!found && !guard.stopped() && layer_sizes.back() > 0) {
+        size_t depth = layer_sizes.size() - 1;
+        std::vector<fs::path> runs;
+        auto spill = [&] {
+            runs.push_back(scratch.file("run-" + std::to_string(runs_written++)));
+            records_written += write_run(buffer, words, runs.back(), order);
+        };
+        RecordReader reader(layer_path(depth), words);
+        for (const uint64_t* current = reader.next(); current; current = reader.next()) {
+            if (guard.exceeded(explored, memory)) {
+                break;
+            }
+            State state = codec.unpack(current);
+            explored++;
+            int distance = progress(*table, state);
+            if (distance < closest_distance) {
+                closest_distance = distance;
+                closest = state;
+                closest_depth = depth;
+            }
+            stats.closed();
+            observer->on_expand(*table, state);
+            stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+            stats.generated(moves.size());
+            for (const auto& move : moves) {
+                table->apply_move(state, move);
+                codec.pack(state, record.data());
+                table->undo_move(state, move);
+                buffer.insert(buffer.end(), record.begin(), record.end());
+                if (buffer.size() >= capacity * words) {
+                    spill();
+                }
+            }
+        }
+        if (guard.stopped()) {
+            buffer.clear();
+            for (const auto& run : runs) {
+                fs::remove(run);
+            }
+            break;
+        }
+        if (!buffer.empty()) {
+            spill();
+        }
+        // Too many runs to open at once: merge them in groups first
+        while (runs.size() > MAX_MERGE_FAN_IN) {
+            std::vector<fs::path> group(runs.begin(), runs.begin() + MAX_MERGE_FAN_IN);
+            runs.erase(runs.begin(), runs.begin() + MAX_MERGE_FAN_IN);
+            runs.push_back(scratch.file("run-" + std::to_string(runs_written++)));
+            RecordWriter writer(runs.back(), words);
+            merge_runs(group, words, [&](const uint64_t* r) {
+                if (guard.exceeded(explored, memory)) {
+                    return false;
+                }
+                writer.put(r);
+                return true;
+            });
+            writer.close();
+            records_written += writer.size();
+            for (const auto& run : group) {
+                fs::remove(run);
+            }
+            if (guard.stopped()) {
+                break;
+            }
+        }
+        if (guard.stopped()) {
+            for (const auto& run : runs) {
+                fs::remove(run);
+            }
+            break;
+        }
+
+        RecordReader current_layer(layer_path(depth), words);
+        std::unique_ptr<RecordReader> previous_layer;
+        if (depth > 0) {
+            previous_layer = std::make_unique<RecordReader>(layer_path(depth - 1), words);
+        }
+        const uint64_t* current_head = current_layer.next();
+        const uint64_t* previous_head = previous_layer ? previous_layer->next() : nullptr;
+        RecordWriter writer(layer_path(depth + 1), words);
+        merge_runs(runs, words, [&](const uint64_t* candidate) {
+            if (guard.exceeded(explored, memory)) {
+                return false;
+            }
+            while (current_head && compare(current_head, candidate, words) < 0) {
+                current_head = current_layer.next();
+            }
+            while (previous_head && compare(previous_head, candidate, words) < 0) {
+                previous_head = previous_layer->next();
+            }
+            if ((current_head && compare(current_head, candidate, words) == 0) ||
+                (previous_head && compare(previous_head, candidate, words) == 0)) {
+                return true;
+            }
+            writer.put(candidate);
+            State state = codec.unpack(candidate);
+            if (table->is_goal(state)) {
+                found = true;
+                goal = state;
+                return false;
+            }
+            return true;
+        });
+        writer.close();
+        for (const auto& run : runs) {
+            fs::remove(run);
+        }
+        records_written += writer.size();
+        if (guard.stopped()) {
+            break;  // The half-merged layer is dropped; the scratch directory removes its file
+        }
+        layer_sizes.push_back(writer.size());
+        largest_layer = std::max(largest_layer, writer.size());
+        stats.open_size(writer.size());
+    }
+    uint64_t stored = 0;
+    for (uint64_t size : layer_sizes) {
+        stored += size;
+    }
+    stats.memory(codec.record_bytes() * stored, stored);
+
+    // Walks back one layer at a time to any neighbour stored in the layer before. A checked trace
+    // gives up with an empty path once the budget runs out.
+    auto trace = [&](const State& last, size_t last_depth, bool checked) {
+        std::vector<State> states = {last};
+        State current = last;
+        for (size_t depth = last_depth; depth-- > 0;) {
+            table->get_moves(current, moves);
+            for (const auto& move : moves) {
+                if (checked && guard.exceeded(explored, memory)) {
+                    return std::vector<Steps>();
+                }
+                State previous = current;
+                table->apply_move(previous, move);
+                codec.pack(previous, record.data());
+                if (contains(layer_path(depth), record.data(), words, layer_sizes[depth])) {
+                    current = previous;
+                    break;
+                }
+            }
+            states.push_back(current);
+        }
+        std::vector<Steps> steps;
+        for (auto it = states.rbegin(); it != states.rend(); ++it) {
+            steps.emplace_back(table, *it);
+        }
+        return steps;
+    };
+    std::vector<Steps> path;
+    if (found) {
+        path = trace(goal, layer_sizes.size() - 1, true);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    std::vector<std::pair<std::string, long long>> extra_stats = {
+        {"Layers", static_cast<long long>(layer_sizes.size())},
+        {"Largest layer", static_cast<long long>(largest_layer)},
+        {"Sorted runs written", runs_written},
+        {"Bytes written to disk", static_cast<long long>(records_written * codec.record_bytes())},
+        {"Bytes per record", static_cast<long long>(codec.record_bytes())},
+    };
+    int move_count = path.empty() ? 0 : static_cast<int>(path.size()) - 1;
+    Result result = {path, move_count, explored, elapsed_time.count(), extra_stats};
+    // Once the budget ran out while tracing the solution there is nothing left to trace another path with
+    if (guard.stopped()) {
+        result.status = guard.get_status();
+        if (!found) {
+            result.partial_path = trace(closest, closest_depth, false);
+        }
+    }
+    return finish(result, stats);
+}
@@ -0,0 +1,249 @@
+#include "Algorithms.hpp"
+#include "Mailbox.hpp"
+#include "WorkQueue.hpp"
+#include <atomic>
+#include <mutex>
+
+namespace {
+    struct HdaMessage {
+        State state;
+        uint32_t parent;
+        uint16_t parent_thread;
+        Move move;
+        double g;
+    };
+
+    struct HdaWorker {
+        NodeArena arena;
+        std::vector<uint16_t> parent_thread;    // Which worker's arena each node's parent lives in
+        Mailbox<HdaMessage> mailbox;
+        int expanded = 0;
+        SearchStats stats;
+        BudgetGuard guard;  // Holds this worker's share of the node and memory budget
+        HdaWorker(const SearchBudget& budget, std::chrono::steady_clock::time_point start) : guard(budget, start) {}
+    };
+
+    constexpr size_t OUTBOX_BATCH = 64;
+}
+
+Algorithms::Result HDAStar::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto budget_start = std::chrono::steady_clock::now();   // Every worker's time limit runs from here
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    prepare_heuristic(*table, start);
+    if (table->is_goal(start)) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed_time = end_time - start_time;
+        return {{Steps(table, start)}, 0, 1, elapsed_time.count()};
+    }
+    int worker_count = threads > 0 ? threads : default_thread_count();
+    worker_count = std::min(worker_count, 0xFFFF);
+    SearchBudget share = budget;
+    share.nodes = (budget.nodes + worker_count - 1) / worker_count;
+    share.memory_megabytes = (budget.memory_megabytes + worker_count - 1) / worker_count;
+    std::vector<std::unique_ptr<HdaWorker>> workers;
+    for (int i = 0; i < worker_count; ++i) {
+        workers.push_back(std::make_unique<HdaWorker>(share, budget_start));
+    }
+    auto owner = [worker_count](const State& state) {
+        return static_cast<int>((state.hash >> 32) % static_cast<uint64_t>(worker_count));
+    };
+
+    // Termination: messages are counted in in_flight from the moment they are buffered until the
+    // receiver has inserted them, and an idle worker sends nothing. A receiver bumps epoch before it
+    // leaves the idle state, so an epoch that is unchanged from before the idle count is read until
+    // after in_flight is read means every worker stayed idle in between. The in_flight load then sees
+    // every outstanding message, and when there are none no work can appear again.
+    std::atomic<long long> in_flight{1};
+    std::atomic<int> idle_count{0};
+    std::atomic<uint64_t> epoch{0};
+    std::atomic<bool> done{false};
+    std::atomic<double> best_cost{std::numeric_limits<double>::infinity()};
+    std::mutex best_mutex;
+    int best_thread = -1;
+    uint32_t best_node = NO_PARENT;
+    workers[owner(start)]->mailbox.push({{start, NO_PARENT, 0, {}, 0.0}});
+
+    auto run = [&](size_t index) {
+        int id = static_cast<int>(index);
+        HdaWorker& self = *workers[id];
+        std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, PQCompare<double>> frontier;
+        std::vector<std::vector<HdaMessage>> outbox(worker_count);
+        std::vector<HdaMessage> inbox;
+        std::vector<Move> moves;
+        bool idle = false;
+        auto flush = [&]() {
+            for (int d = 0; d < worker_count; ++d) {
+                if (!outbox[d].empty()) {
+                    workers[d]->mailbox.push(std::move(outbox[d]));
+                    outbox[d].clear();
+                }
+            }
+        };
+        try {
+            while (!done.load()) {
+                if (self.guard.exceeded(self.expanded, [&] { return self.arena.memory_usage() + frontier.size() * sizeof(std::pair<double, uint32_t>); })) {
+                    done = true;
+                    break;
+                }
+                inbox.clear();
+                size_t received = self.mailbox.drain(inbox);
+                if (received > 0 && idle) {
+                    epoch++;
+                    idle_count--;
+                    idle = false;
+                }
+                for (const auto& message : inbox) {
+                    double f = message.g + self.stats.timed(SearchStats::HEURISTIC, [&] { return heuristic(*table, message.state); });
+                    if (f >= best_cost.load()) {
+                        continue;
+                    }
+                    auto [node_id, inserted] = self.stats.timed(SearchStats::HASHING, [&] {
+                        return self.arena.insert(message.state, message.parent, message.move, message.g);
+                    });
+                    if (inserted) {
+                        self.parent_thread.push_back(message.parent_thread);
+                    } else {
+                        Node& node = self.arena[node_id];
+                        if (message.g >= node.g) {
+                            self.stats.duplicate();
+                            continue;
+                        }
+                        if (node.closed) {
+                            self.stats.reopened();
+                        } else {
+                            self.stats.updated();
+                        }
+                        // A cheaper path arrived late: reopen the node even if it was already expanded
+                        node.parent = message.parent;
+                        node.move = message.move;
+                        node.g = message.g;
+                        node.closed = false;
+                        self.parent_thread[node_id] = message.parent_thread;
+                    }
+                    self.stats.timed(SearchStats::QUEUE, [&] { frontier.push({f, node_id}); });
+                }
+                self.stats.open_size(frontier.size());
+                if (received > 0) {
+                    in_flight -= static_cast<long long>(received);
+                }
+
+                if (!frontier.empty() && frontier.top().first < best_cost.load()) {
+                    uint32_t current = self.stats.timed(SearchStats::QUEUE, [&] {
+                        uint32_t top = frontier.top().second;
+                        frontier.pop();
+                        return top;
+                    });
+                    if (self.arena[current].closed) {
+                        continue;
+                    }
+                    self.arena[current].closed = true;
+                    self.stats.closed();
+                    self.expanded++;
+                    State state = self.arena[current].state;
+                    double g = self.arena[current].g;
+                    if (id == 0) {
+                        observer->on_expand(*table, state);
+                    }
+                    if (table->is_goal(state)) {
+                        std::lock_guard<std::mutex> lock(best_mutex);
+                        if (g < best_cost.load()) {
+                            best_cost = g;
+                            best_thread = id;
+                            best_node = current;
+                        }
+                        continue;
+                    }
+                    self.stats.timed(SearchStats::EXPANSION, [&] { table->get_moves(state, moves); });
+                    self.stats.generated(moves.size());
+                    for (const auto& move : moves) {
+                        State next = state;
+                        table->apply_move(next, move);
+                        int destination = owner(next);
+                        in_flight++;
+                        outbox[destination].push_back({next, current, static_cast<uint16_t>(id), move, g + 1.0});
+                        if (outbox[destination].size() >= OUTBOX_BATCH) {
+                            workers[destination]->mailbox.push(std::move(outbox[destination]));
+                            outbox[destination].clear();
+                        }
+                    }
+                    if (frontier.empty() || self.expanded % 16 == 0) {
+                        flush();
+                    }
+                    continue;
+                }
+
+                flush();
+                if (!idle) {
+                    idle = true;
+                    idle_count++;
+                }
+                uint64_t seen_epoch = epoch.load();
+                if (idle_count.load() == worker_count && in_flight.load() == 0 && epoch.load() == seen_epoch) {
+                    done = true;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        } catch (...) {
+            done = true;
+            throw;
+        }
+    };
+    run_work_queue(static_cast<size_t>(worker_count), worker_count, run);
+
+    int states_explored = 0;
+    SearchStats stats;
+    for (const auto& worker : workers) {
+        states_explored += worker->expanded;
+        worker->stats.memory(worker->arena.memory_usage(), worker->arena.size());
+        stats.merge(worker->stats);
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    // Parents may live in another worker's arena
+    auto trace = [&](int thread, uint32_t goal) {
+        std::vector<Steps> path;
+        for (uint32_t i = goal; i != NO_PARENT;) {
+            const Node& node = workers[thread]->arena[i];
+            path.emplace_back(table, node.state);
+            int parent_thread = workers[thread]->parent_thread[i];
+            i = node.parent;
+            thread = parent_thread;
+        }
+        std::reverse(path.begin(), path.end());
+        return path;
+    };
+    Result result = {{}, 0, states_explored, elapsed_time.count()};
+    if (best_thread != -1) {
+        result.path = trace(best_thread, best_node);
+        result.move_count = static_cast<int>(result.path.size()) - 1;
+    }
+    // A solution found before the budget ran out is kept, but it may not be the shortest
+    for (const auto& worker : workers) {
+        if (worker->guard.stopped()) {
+            result.status = worker->guard.get_status();
+        }
+    }
+    if (result.status != SolveStatus::FINISHED) {
+        int best_distance = std::numeric_limits<int>::max();
+        int closest_thread = -1;
+        uint32_t closest_node = NO_PARENT;
+        for (int thread = 0; thread < worker_count; ++thread) {
+            const NodeArena& arena = workers[thread]->arena;
+            for (uint32_t i = 0; i < arena.size(); ++i) {
+                int distance = progress(*table, arena[i].state);
+                if (distance < best_distance) {
+                    best_distance = distance;
+                    closest_thread = thread;
+                    closest_node = i;
+                }
+            }
+        }
+        if (closest_thread != -1) {
+            result.partial_path = trace(closest_thread, closest_node);
+        }
+    }
+    return finish(result, stats);
+}
@@ -0,0 +1,71 @@
+#include "NodeArena.hpp"
+
+// Different states may share a hash, so every index entry under it is compared in full
+uint32_t NodeArena::lookup(const State& state, size_t hash) const {
+    auto [first, last] = index.equal_range(hash);
+    for (auto it = first; it != last; ++it) {
+        if (nodes[it->second].state == state) {
+            return it->second;
+        }
+    }
+    return NO_PARENT;
+}
+
+// Returns the index of the node holding state and whether it was newly added.
+// An existing node is left untouched; callers decide whether the new parent is better.
+std::pair<uint32_t, bool> NodeArena::insert(const State& state, uint32_t parent, const Move& move, double g) {
+    size_t hash = std::hash<State>{}(state);
+    uint32_t existing = lookup(state, hash);
+    if (existing != NO_PARENT) {
+        return {existing, false};
+    }
+    if (nodes.size() >= NO_PARENT) {
+        throw StateException("Node arena is full");
+    }
+    uint32_t id = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({state, parent, move, false, g});
+    index.emplace(hash, id);
+    return {id, true};
+}
+
+// Index of the node holding state, or NO_PARENT
+uint32_t NodeArena::find(const State& state) const {
+    return lookup(state, std::hash<State>{}(state));
+}
+
+size_t NodeArena::memory_usage() const {
+    // Each index entry is a separately allocated node holding the next pointer, the hash and the index
+    size_t index_node = sizeof(void*) + sizeof(size_t) + sizeof(uint32_t);
+    return nodes.capacity() * sizeof(Node) + index.size() * index_node + index.bucket_count() * sizeof(void*);
+}
+
+void NodeArena::clear() {
+    index.clear();
+    nodes.clear();
+}
+
+// Node indices from the root to goal, found by walking parents backwards and reversing once
+std::vector<uint32_t> NodeArena::trace(uint32_t goal) const {
+    std::vector<uint32_t> path;
+    for (uint32_t i = goal; i != NO_PARENT; i = nodes[i].parent) {
+        path.push_back(i);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+HashStats NodeArena::bucket_stats(const std::function<size_t(const State&)>& hasher) const {
+    HashStats stats;
+    stats.elements = nodes.size();
+    stats.buckets = index.bucket_count();
+    std::vector<size_t> chain(stats.buckets, 0);
+    for (const auto& node : nodes) {
+        size_t& length = chain[hasher(node.state) % stats.buckets];
+        if (length > 0) {
+            stats.collisions++;
+        }
+        length++;
+        stats.longest_chain = std::max(stats.longest_chain, length);
+    }
+    return stats;
+}
@@ -0,0 +1,203 @@
+#include "PatternDatabase.hpp"
+#include <algorithm>
+#include <deque>
+#include <sstream>
+
+std::map<std::string, std::shared_ptr<const PatternDatabase>> PatternDatabase::cache;
+std::mutex PatternDatabase::cache_mutex;
+
+namespace {
+    constexpr size_t CACHE_LIMIT = 256;
+
+    int lane_positions(const PieceInfo& info) {
+        return info.lane_size - info.length + 1;
+    }
+}
+
+// The primary car and its lane mates, followed in crossing order by every perpendicular car whose
+// lane cuts the primary's lane between the primary and the far end of the goal
+std::vector<int> PatternDatabase::lane_pieces(const PieceTable& table, const State& start, std::vector<int>& crossing) {
+    crossing.clear();
+    int primary = table.get_primary();
+    const PieceInfo& primary_info = table.get_pieces()[primary];
+    int first = start.offsets[primary];
+    int last = first + primary_info.length - 1;
+    State probe;
+    for (int offset = 0; offset < lane_positions(primary_info); ++offset) {
+        probe.offsets[primary] = static_cast<uint8_t>(offset);
+        if (table.is_goal(probe)) {
+            first = std::min(first, offset);
+            last = std::max(last, offset + primary_info.length - 1);
+        }
+    }
+    std::vector<int> lane = {primary};
+    for (int i = 0; i < table.size(); ++i) {
+        const PieceInfo& info = table.get_pieces()[i];
+        if (i == primary) {
+            continue;
+        }
+        if (info.orientation == primary_info.orientation && info.lane == primary_info.lane) {
+            lane.push_back(i);
+        } else if (info.orientation != primary_info.orientation && info.lane >= first && info.lane <= last) {
+            crossing.push_back(i);
+        }
+    }
+    // Closest to the primary first, so splitting keeps the cars that matter most in one group
+    int head = start.offsets[primary];
+    std::stable_sort(crossing.begin(), crossing.end(), [&](int a, int b) {
+        return std::abs(table.get_pieces()[a].lane - head) < std::abs(table.get_pieces()[b].lane - head);
+    });
+    return lane;
+}
+
+std::string PatternDatabase::signature(const PieceTable& table, const std::vector<int>& pieces) {
+    std::ostringstream key;
+    key << table.get_rows() << 'x' << table.get_cols();
+    State probe;
+    int primary = table.get_primary();
+    for (int offset = 0; offset < lane_positions(table.get_pieces()[primary]); ++offset) {
+        probe.offsets[primary] = static_cast<uint8_t>(offset);
+        key << (table.is_goal(probe) ? 'g' : '.');
+    }
+    for (int i : pieces) {
+        const PieceInfo& info = table.get_pieces()[i];
+        key << ';' << i << ',' << info.length << ',' << (info.orientation == Orientation::HORIZONTAL ? 'h' : 'v') << ',' << info.lane;
+    }
+    return key.str();
+}
+
+PatternDatabase::PatternDatabase(const PieceTable& table, const State& start) {
+    std::vector<int> crossing;
+    std::vector<int> lane = lane_pieces(table, start, crossing);
+    size_t lane_size = 1;
+    for (int i : lane) {
+        lane_size *= lane_positions(table.get_pieces()[i]);
+    }
+    if (lane_size > MAX_ENTRIES) {
+        return;
+    }
+    // Greedily fill each group with crossing cars until its table would grow past MAX_ENTRIES
+    std::vector<std::vector<int>> groups(1);
+    size_t group_size = lane_size;
+    for (int i : crossing) {
+        size_t positions = lane_positions(table.get_pieces()[i]);
+        if (group_size * positions > MAX_ENTRIES && !groups.back().empty()) {
+            groups.emplace_back();
+            group_size = lane_size;
+        }
+        if (group_size * positions > MAX_ENTRIES) {
+            continue;
+        }
+        groups.back().push_back(i);
+        group_size *= positions;
+    }
+    for (size_t g = 0; g < groups.size(); ++g) {
+        Pattern pattern;
+        for (int i : lane) {
+            pattern.pieces.push_back(i);
+            pattern.counted.push_back(g == 0);
+        }
+        for (int i : groups[g]) {
+            pattern.pieces.push_back(i);
+            pattern.counted.push_back(true);
+        }
+        build(table, pattern);
+        entries += pattern.distances.size();
+        patterns.push_back(std::move(pattern));
+    }
+}
+
+// 0-1 breadth-first search backwards from every abstract goal layout. Moves are reversible, so the
+// backward moves are the ordinary slides.
+void PatternDatabase::build(const PieceTable& table, Pattern& pattern) {
+    size_t count = pattern.pieces.size();
+    std::vector<int> radix(count);
+    pattern.strides.resize(count);
+    uint32_t total = 1;
+    for (size_t k = 0; k < count; ++k) {
+        radix[k] = lane_positions(table.get_pieces()[pattern.pieces[k]]);
+        pattern.strides[k] = total;
+        total *= radix[k];
+    }
+    pattern.distances.assign(total, UNREACHABLE);
+
+    State state;
+    Bitboard occupied;
+    auto unrank = [&](uint32_t rank) {
+        occupied.reset();
+        bool valid = true;
+        for (size_t k = 0; k < count; ++k) {
+            int piece = pattern.pieces[k];
+            state.offsets[piece] = static_cast<uint8_t>((rank / pattern.strides[k]) % radix[k]);
+            int cell = table.cell_index(piece, state.offsets[piece]);
+            int step = table.cell_step(piece);
+            for (int c = 0; c < table.get_pieces()[piece].length; ++c, cell += step) {
+                valid = valid && !occupied.test(cell);
+                occupied.set(cell);
+            }
+        }
+        return valid;
+    };
+
+    std::deque<std::pair<uint32_t, uint8_t>> queue;
+    for (uint32_t rank = 0; rank < total; ++rank) {
+        if (unrank(rank) && table.is_goal(state)) {
+            pattern.distances[rank] = 0;
+            queue.push_back({rank, 0});
+        }
+    }
+    while (!queue.empty()) {
+        auto [rank, distance] = queue.front();
+        queue.pop_front();
+        if (pattern.distances[rank] != distance) {
+            continue;
+        }
+        unrank(rank);
+        for (size_t k = 0; k < count; ++k) {
+            int piece = pattern.pieces[k];
+            const PieceInfo& info = table.get_pieces()[piece];
+            int offset = state.offsets[piece];
+            int step = table.cell_step(piece);
+            uint8_t next_distance = static_cast<uint8_t>(std::min(distance + (pattern.counted[k] ? 1 : 0), UNREACHABLE - 1));
+            auto relax = [&](int to) {
+                uint32_t next = rank + static_cast<uint32_t>(to) * pattern.strides[k] - static_cast<uint32_t>(offset) * pattern.strides[k];
+                if (next_distance < pattern.distances[next]) {
+                    pattern.distances[next] = next_distance;
+                    if (pattern.counted[k]) {
+                        queue.push_back({next, next_distance});
+                    } else {
+                        queue.push_front({next, next_distance});
+                    }
+                }
+            };
+            for (int o = offset - 1; o >= 0 && !occupied.test(table.cell_index(piece, o)); --o) {
+                relax(o);
+            }
+            int tail = table.cell_index(piece, offset) + info.length * step;
+            for (int o = offset + 1; o + info.length <= info.lane_size && !occupied.test(tail); ++o, tail += step) {
+                relax(o);
+            }
+        }
+    }
+}
+
+std::shared_ptr<const PatternDatabase> PatternDatabase::load(const PieceTable& table, const State& start) {
+    if (table.get_primary() == -1) {
+        return nullptr;
+    }
+    std::vector<int> crossing;
+    std::vector<int> pieces = lane_pieces(table, start, crossing);
+    pieces.insert(pieces.end(), crossing.begin(), crossing.end());
+    std::string key = signature(table, pieces);
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    if (cache.size() >= CACHE_LIMIT) {
+        cache.clear();
+    }
+    std::shared_ptr<const PatternDatabase> database(new PatternDatabase(table, start));
+    cache[key] = database;
+    return database;
+}
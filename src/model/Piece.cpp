@@ -1,9 +1,7 @@
 #include "Piece.hpp"
 
-int Secondary::counter = 0;
-Secondary::Secondary(std::string id, int length, const Position& pos, const Orientation& orientation) : Piece(id, length, pos, orientation, static_cast<Color>(counter % 3 + 1)) {
-    counter++;
-}
+std::atomic<int> Secondary::counter{0};
+Secondary::Secondary(std::string id, int length, const Position& pos, const Orientation& orientation) : Piece(id, length, pos, orientation, static_cast<Color>(counter.fetch_add(1) % 3 + 1)) {}
 
 Piece::Piece(std::string id, int length, const Position& pos, const Orientation& orient, const Color& co) : id(id), length(length), head(pos), orientation(orient), color(co) {
     positions.clear();
@@ -28,16 +26,12 @@ Piece::Piece(const Piece& other) : id(other.id), length(other.length), head(othe
 
 void Piece::move(Position newHead) {
     head = newHead;
-    positions.clear();
-    if (orientation == Orientation::HORIZONTAL) {
-        for (int i = head.col; i < head.col + length; i++) {
-            Position x(head.row, i);
-            positions.push_back(x);
-        }
-    } else {
-        for (int i = head.row; i < head.row + length; i++) {
-            Position x(i, head.col);
-            positions.push_back(x);
+    // The piece keeps its length, so positions are rewritten in place instead of reallocated
+    for (int i = 0; i < length; i++) {
+        if (orientation == Orientation::HORIZONTAL) {
+            positions[i] = Position(head.row, head.col + i);
+        } else {
+            positions[i] = Position(head.row + i, head.col);
         }
     }
 }
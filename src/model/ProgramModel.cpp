@@ -1,27 +1,62 @@
 #include "model/ProgramModel.hpp"
 #include <iostream>
+#include <fstream>
+#include <cmath>
+
+namespace {
+// Rebuilds a cached solution's path, checking each move against the legal moves of the state it is
+// applied to and the last state against the goal. A cache file is outside our control, so an entry
+// from an edited file or a different board must not reach apply_move unchecked.
+bool replay(const std::shared_ptr<const PieceTable>& table, State state, const std::vector<Move>& moves, std::vector<Steps>& path) {
+    std::vector<Move> legal;
+    path.emplace_back(table, state);
+    for (const auto& move : moves) {
+        table->get_moves(state, legal);
+        bool found = std::any_of(legal.begin(), legal.end(), [&](const Move& candidate) {
+            return candidate.piece == move.piece && candidate.from == move.from && candidate.to == move.to;
+        });
+        if (!found) {
+            return false;
+        }
+        table->apply_move(state, move);
+        path.emplace_back(table, state);
+    }
+    return table->is_goal(state);
+}
+}
 
 ProgramModel::ProgramModel() {
     init();
 }
 
 void ProgramModel::init() {
-    algorithms["a*"] = std::make_shared<AStar>();
-    algorithms["uniformcostsearch"] = std::make_shared<UCS>();
-    algorithms["ucs"] = std::make_shared<UCS>();
-    algorithms["greddybestfirstsearch"] = std::make_shared<GBFS>();
-    algorithms["gbfs"] = std::make_shared<GBFS>();
-    algorithms["a"] = std::make_shared<AStar>();
-    algorithms["iterativedeepeninga*"] = std::make_shared<IDA>();
-    algorithms["ida*"] = std::make_shared<IDA>();
+    algorithms["a*"] = [] { return std::make_shared<AStar>(); };
+    algorithms["uniformcostsearch"] = [] { return std::make_shared<UCS>(); };
+    algorithms["ucs"] = [] { return std::make_shared<UCS>(); };
+    algorithms["greddybestfirstsearch"] = [] { return std::make_shared<GBFS>(); };
+    algorithms["gbfs"] = [] { return std::make_shared<GBFS>(); };
+    algorithms["a"] = [] { return std::make_shared<AStar>(); };
+    algorithms["anytimea*"] = [] { return std::make_shared<AnytimeAStar>(); };
+    algorithms["ara*"] = [] { return std::make_shared<AnytimeAStar>(); };
+    algorithms["iterativedeepeninga*"] = [this] { return std::make_shared<IDA>(ida_table_megabytes); };
+    algorithms["ida*"] = [this] { return std::make_shared<IDA>(ida_table_megabytes); };
+    algorithms["hashdistributeda*"] = [] { return std::make_shared<HDAStar>(); };
+    algorithms["hda*"] = [] { return std::make_shared<HDAStar>(); };
+    algorithms["bidirectionalbfs"] = [] { return std::make_shared<BidirectionalBFS>(); };
+    algorithms["bibfs"] = [] { return std::make_shared<BidirectionalBFS>(); };
+    algorithms["externalbfs"] = [this] { return std::make_shared<ExternalBFS>(external_memory_megabytes, external_directory); };
+    algorithms["external"] = [this] { return std::make_shared<ExternalBFS>(external_memory_megabytes, external_directory); };
+    algorithms["beamsearch"] = [this] { return std::make_shared<BeamSearch>(beam_width); };
+    algorithms["beam"] = [this] { return std::make_shared<BeamSearch>(beam_width); };
+    algorithms["retrogradeanalysis"] = [] { return std::make_shared<Retrograde>(); };
+    algorithms["retrograde"] = [] { return std::make_shared<Retrograde>(); };
+    algorithms["solutiondatabase"] = [this] { return make_database_lookup(); };
+    algorithms["database"] = [this] { return make_database_lookup(); };
 
 }
 
 void ProgramModel::create_board(int rows, int cols, int sec_count, std::vector<std::string> board_config) {
     Position goal_pos = Reader::find_goal_position(board_config, rows, cols);
-    std::cout << "Goal position: " << goal_pos.row << ", " << goal_pos.col << std::endl;
-    std::cout << "Press Enter to continue..." << std::endl;
-    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     initial_board = Board(rows, cols, goal_pos);
     std::map<char, std::vector<Position>> pieces_positions;
     int start_row = 0;
@@ -52,7 +87,6 @@ void ProgramModel::create_board(int rows, int cols, int sec_count, std::vector<s
     int secondary_count = 0;
     for (const auto& pair : pieces_positions) {
         if (pair.first != 'P' && pair.first != '.') {
-            std::cout << "Secondary car: " << pair.first << std::endl;
             secondary_count++;
         }
     }
@@ -87,11 +121,89 @@ void ProgramModel::create_board(int rows, int cols, int sec_count, std::vector<s
     }
 }
 
-Algorithms::Result ProgramModel::run_solver(const std::string& algorithm, const std::string& heuristics) {
+void ProgramModel::load_board(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filepath);
+    }
+    auto [rows, cols] = Reader::read_dimensions(file);
+    int secondary_count = Reader::read_secondary_count(file);
+    std::vector<std::string> board_config = Reader::read_board_config(file, rows, cols);
+    create_board(rows, cols, secondary_count, board_config);
+}
+
+void ProgramModel::save_solution_database(const std::string& filepath) const {
+    auto table = std::make_shared<const PieceTable>(initial_board);
+    RetrogradeAnalysis analysis(table, table->encode(initial_board));
+    SolutionDatabase::write(filepath, analysis);
+}
+
+void ProgramModel::load_solution_database(const std::string& filepath) {
+    solution_database = std::make_shared<const SolutionDatabase>(filepath);
+}
+
+std::shared_ptr<Algorithms> ProgramModel::make_database_lookup() const {
+    if (!solution_database) {
+        throw SolutionDatabaseException("No solution database loaded");
+    }
+    return std::make_shared<DatabaseLookup>(solution_database);
+}
+
+// Every setting a factory passes to its solver, so results of differently configured solvers never share
+// a cache entry. Budgets are not included because budgeted results are never cached.
+std::string ProgramModel::solver_parameters() const {
+    return "ida-tt-mb=" + std::to_string(ida_table_megabytes) + ",ext-mb=" + std::to_string(external_memory_megabytes)
+           + ",beam-width=" + std::to_string(beam_width);
+}
+
+Algorithms::Result ProgramModel::run_solver(const std::string& algorithm, const std::string& heuristics, const SearchBudget& budget) const {
     auto it = algorithms.find(algorithm);
     if (it == algorithms.end()) {
         throw std::runtime_error("Algorithm not found: " + algorithm);
     }
-    it->second->set_heuristics(heuristics);
-    return it->second->solve(initial_board);
+    std::shared_ptr<SolutionCache> cache = budget.unlimited() ? solution_cache : nullptr;
+    std::string key;
+    if (cache) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        key = SolutionCache::make_key(initial_board, algorithm, heuristics, solver_parameters());
+        SolutionCache::Entry entry;
+        if (cache->find(key, entry)) {
+            // Replay the stored moves; the reported time is the lookup, the original search time is kept as a stat
+            auto table = std::make_shared<const PieceTable>(initial_board);
+            std::vector<Steps> path;
+            if (!entry.solved || replay(table, table->encode(initial_board), entry.moves, path)) {
+                auto end_time = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> elapsed_time = end_time - start_time;
+                entry.extra_stats.push_back({"Cached search time (us)", std::llround(entry.time_taken * 1e6)});
+                return {path, static_cast<int>(entry.moves.size()), entry.states_explored, elapsed_time.count(), entry.extra_stats};
+            }
+            // A corrupt entry is dropped and the board solved again below
+            cache->evict(key);
+        }
+    }
+    std::shared_ptr<Algorithms> solver = it->second();
+    solver->set_heuristics(heuristics);
+    solver->set_observer(observer);
+    solver->set_budget(budget);
+    Algorithms::Result result = solver->solve(initial_board);
+    if (cache) {
+        SolutionCache::Entry entry;
+        entry.key = key;
+        entry.solved = !result.path.empty();
+        entry.states_explored = result.states_explored;
+        entry.time_taken = result.time_taken;
+        entry.extra_stats = result.extra_stats;
+        for (size_t i = 1; i < result.path.size(); ++i) {
+            const State& before = result.path[i - 1].get_state();
+            const State& after = result.path[i].get_state();
+            for (int piece = 0; piece < MAX_PIECES; ++piece) {
+                if (before.offsets[piece] != after.offsets[piece]) {
+                    entry.moves.push_back({static_cast<uint8_t>(piece), before.offsets[piece], after.offsets[piece]});
+                    break;
+                }
+            }
+        }
+        cache->insert(std::move(entry));
+    }
+    return result;
 }
\ No newline at end of file
@@ -0,0 +1,318 @@
+#include "PuzzleGenerator.hpp"
+#include <algorithm>
+#include <random>
+#include <unordered_set>
+#include "Corpus.hpp"
+#include "State.hpp"
+#include "WorkQueue.hpp"
+
+namespace {
+    // Row-major cells with the pieces relabelled in order of first appearance, so the same layout
+    // always gives the same string whatever order its pieces were placed in
+    std::string canonical_cells(const PieceTable& table, const State& state) {
+        OwnerGrid owners = table.owners(state);
+        int cell_count = table.get_rows() * table.get_cols();
+        std::string cells(cell_count, 'o');
+        std::vector<char> label(table.size(), 0);
+        size_t next = 0;
+        for (int cell = 0; cell < cell_count; ++cell) {
+            int piece = owners[cell];
+            if (piece < 0) {
+                continue;
+            }
+            if (!label[piece]) {
+                label[piece] = piece == table.get_primary() ? CORPUS_PRIMARY : CORPUS_LABELS[next++];
+            }
+            cells[cell] = label[piece];
+        }
+        return cells;
+    }
+
+    // Every state of one component as packed keys in discovery order, indexed by an open-addressing
+    // table of positions into keys. Far smaller and faster to probe than a hash map of States.
+    class ComponentIndex {
+    private:
+        static constexpr uint32_t EMPTY = 0xFFFFFFFF;
+        int words;
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> slots = std::vector<uint32_t>(1024, EMPTY);
+        uint32_t count = 0;
+        size_t slot_of(const uint64_t* key) const {
+            uint64_t hash = 0;
+            for (int w = 0; w < words; ++w) {
+                hash = (hash ^ key[w]) * 0x9E3779B97F4A7C15ULL;
+            }
+            return static_cast<size_t>(hash ^ (hash >> 29)) & (slots.size() - 1);
+        }
+        void grow() {
+            slots.assign(slots.size() * 2, EMPTY);
+            for (uint32_t i = 0; i < count; ++i) {
+                size_t slot = slot_of(key(i));
+                while (slots[slot] != EMPTY) {
+                    slot = (slot + 1) & (slots.size() - 1);
+                }
+                slots[slot] = i;
+            }
+        }
+    public:
+        ComponentIndex(int words) : words(words) {}
+        uint32_t size() const { return count; }
+        const uint64_t* key(uint32_t i) const { return keys.data() + static_cast<size_t>(i) * words; }
+        // The key's index, and whether it was new
+        std::pair<uint32_t, bool> insert(const uint64_t* key) {
+            if ((count + 1) * 2 > slots.size()) {
+                grow();
+            }
+            for (size_t slot = slot_of(key);; slot = (slot + 1) & (slots.size() - 1)) {
+                if (slots[slot] == EMPTY) {
+                    slots[slot] = count;
+                    keys.insert(keys.end(), key, key + words);
+                    return {count++, true};
+                }
+                if (std::equal(key, key + words, this->key(slots[slot]))) {
+                    return {slots[slot], false};
+                }
+            }
+        }
+    };
+
+    struct Placement {
+        int length;
+        bool horizontal;
+        int row;
+        int col;
+    };
+
+    // A solved layout: the primary car at the exit, then the secondaries, with the cells they cover
+    struct Layout {
+        int rows;
+        int cols;
+        int exit_row;
+        std::vector<Placement> pieces;
+        std::vector<char> occupied;
+
+        Layout(int rows, int cols, int exit_row) : rows(rows), cols(cols), exit_row(exit_row), occupied(rows * cols, 0) {
+            pieces.push_back({2, true, exit_row, cols - 2});
+            mark(pieces.front(), 1);
+        }
+        void mark(const Placement& piece, char value) {
+            int step = piece.horizontal ? 1 : cols;
+            for (int k = 0, cell = piece.row * cols + piece.col; k < piece.length; ++k, cell += step) {
+                occupied[cell] = value;
+            }
+        }
+        bool fits(const Placement& piece) const {
+            int step = piece.horizontal ? 1 : cols;
+            for (int k = 0, cell = piece.row * cols + piece.col; k < piece.length; ++k, cell += step) {
+                if (occupied[cell]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        // Tries a few random spots for a new secondary
+        template<typename Below>
+        bool add_random(Below& below) {
+            for (int tries = 0; tries < 50; ++tries) {
+                // Roughly one truck to every three cars, as in the commercial sets
+                Placement piece{below(4) == 0 ? 3 : 2, below(2) == 0, 0, 0};
+                int row_span = piece.horizontal ? 1 : piece.length;
+                int col_span = piece.horizontal ? piece.length : 1;
+                if (row_span > rows || col_span > cols) {
+                    continue;
+                }
+                piece.row = below(rows - row_span + 1);
+                piece.col = below(cols - col_span + 1);
+                // A car sharing the exit row could never let the primary car past
+                if ((piece.horizontal && piece.row == exit_row) || !fits(piece)) {
+                    continue;
+                }
+                mark(piece, 1);
+                pieces.push_back(piece);
+                return true;
+            }
+            return false;
+        }
+        template<typename Below>
+        void remove_random(Below& below) {
+            size_t i = 1 + below(static_cast<int>(pieces.size()) - 1);
+            mark(pieces[i], 0);
+            pieces.erase(pieces.begin() + i);
+        }
+        Board board() const {
+            Board board(rows, cols, Position(exit_row, cols - 1));
+            board.add_piece(std::make_shared<Primary>(2, Position(exit_row, cols - 2), Orientation::HORIZONTAL));
+            for (size_t i = 1; i < pieces.size(); ++i) {
+                const Placement& piece = pieces[i];
+                board.add_piece(std::make_shared<Secondary>(std::string(1, CORPUS_LABELS[i - 1]), piece.length, Position(piece.row, piece.col),
+                                                            piece.horizontal ? Orientation::HORIZONTAL : Orientation::VERTICAL));
+            }
+            return board;
+        }
+    };
+
+    struct Evaluation {
+        int moves = -1;
+        uint32_t component_size = 0;
+        std::string cells;
+    };
+
+    // The deepest state of the layout's component. False when the component has more than
+    // max_states states.
+    bool evaluate(const Layout& layout, size_t max_states, Evaluation& evaluation) {
+        Board board = layout.board();
+        PieceTable table(board);
+        State start = table.encode(board);
+        // Forward sweep over the component, keeping every state's successors as indices (CSR layout)
+        StateCodec codec(table);
+        ComponentIndex component(codec.get_words());
+        std::vector<uint64_t> key(codec.get_words());
+        codec.pack(start, key.data());
+        component.insert(key.data());
+        std::vector<uint32_t> first_edge = {0};
+        std::vector<uint32_t> edges;
+        std::vector<char> goal;
+        std::vector<Move> moves;
+        for (uint32_t i = 0; i < component.size(); ++i) {
+            State state = codec.unpack(component.key(i));
+            goal.push_back(table.is_goal(state));
+            table.get_moves(state, moves);
+            for (const auto& move : moves) {
+                table.apply_move(state, move);
+                codec.pack(state, key.data());
+                auto [next, inserted] = component.insert(key.data());
+                if (inserted && component.size() > max_states) {
+                    return false;
+                }
+                edges.push_back(next);
+                table.undo_move(state, move);
+            }
+            first_edge.push_back(static_cast<uint32_t>(edges.size()));
+        }
+        // Backward BFS from every goal at once; moves are reversible so successors double as predecessors
+        std::vector<int> distance(component.size(), -1);
+        std::vector<uint32_t> layer;
+        std::vector<uint32_t> next_layer;
+        for (uint32_t i = 0; i < component.size(); ++i) {
+            if (goal[i]) {
+                distance[i] = 0;
+                layer.push_back(i);
+            }
+        }
+        int hardest = 0;
+        while (true) {
+            next_layer.clear();
+            for (uint32_t i : layer) {
+                for (uint32_t e = first_edge[i]; e < first_edge[i + 1]; ++e) {
+                    if (distance[edges[e]] == -1) {
+                        distance[edges[e]] = hardest + 1;
+                        next_layer.push_back(edges[e]);
+                    }
+                }
+            }
+            if (next_layer.empty()) {
+                break;
+            }
+            layer.swap(next_layer);
+            hardest++;
+        }
+        // Of the deepest states take the smallest encoding, so every start in a component yields the same puzzle
+        std::string best;
+        for (uint32_t i : layer) {
+            std::string cells = canonical_cells(table, codec.unpack(component.key(i)));
+            if (best.empty() || cells < best) {
+                best = std::move(cells);
+            }
+        }
+        evaluation = {hardest, component.size(), best};
+        return true;
+    }
+}
+
+PuzzleGenerator::PuzzleGenerator(const GeneratorOptions& options) : options(options), exit_row((options.rows - 1) / 2) {
+    if (options.rows < 1 || options.cols < 3 || options.rows * options.cols > MAX_CELLS) {
+        throw GeneratorException("Board size out of range: " + std::to_string(options.rows) + "x" + std::to_string(options.cols));
+    }
+    int most_pieces = std::min<int>(MAX_PIECES, static_cast<int>(CORPUS_LABELS.size()) + 1);
+    if (options.min_pieces < 1 || options.max_pieces < options.min_pieces || options.max_pieces > most_pieces) {
+        throw GeneratorException("Piece counts must satisfy 1 <= min <= max <= " + std::to_string(most_pieces));
+    }
+    if (options.count == 0) {
+        throw GeneratorException("Puzzle count must be positive");
+    }
+}
+
+bool PuzzleGenerator::attempt(uint64_t index, GeneratedPuzzle& puzzle) const {
+    std::seed_seq sequence{static_cast<uint32_t>(options.seed), static_cast<uint32_t>(options.seed >> 32),
+                           static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32)};
+    std::mt19937_64 rng(sequence);
+    // Plain modulo rather than a distribution, whose output differs between standard libraries
+    auto below = [&](int n) { return static_cast<int>(rng() % static_cast<uint64_t>(n)); };
+
+    Layout layout(options.rows, options.cols, exit_row);
+    int target = options.min_pieces + below(options.max_pieces - options.min_pieces + 1);
+    for (int tries = 0; static_cast<int>(layout.pieces.size()) < target && tries < target; ++tries) {
+        layout.add_random(below);
+    }
+    if (static_cast<int>(layout.pieces.size()) < options.min_pieces) {
+        return false;
+    }
+    Evaluation best;
+    evaluate(layout, options.max_component_states, best);
+    // Hill climbing: add, remove or move one secondary and keep the change unless the puzzle got easier
+    for (int step = 0; step < options.climb_steps; ++step) {
+        Layout candidate = layout;
+        int pieces = static_cast<int>(candidate.pieces.size());
+        int change = below(3);
+        bool changed = false;
+        if (change == 0 && pieces < options.max_pieces) {
+            changed = candidate.add_random(below);
+        } else if (change == 1 && pieces > std::max(options.min_pieces, 1)) {
+            candidate.remove_random(below);
+            changed = true;
+        } else if (change == 2 && pieces > 1) {
+            candidate.remove_random(below);
+            changed = candidate.add_random(below);
+        }
+        Evaluation evaluation;
+        if (changed && evaluate(candidate, options.max_component_states, evaluation) && evaluation.moves >= best.moves) {
+            layout = std::move(candidate);
+            best = std::move(evaluation);
+        }
+    }
+    if (best.moves < options.min_moves) {
+        return false;
+    }
+    puzzle = {index, best.moves, static_cast<int>(layout.pieces.size()), best.component_size, best.cells};
+    return true;
+}
+
+std::vector<GeneratedPuzzle> PuzzleGenerator::generate() const {
+    uint64_t limit = options.max_attempts != 0 ? options.max_attempts : options.count * 100;
+    int threads = options.threads == 0 ? default_thread_count() : options.threads;
+    // Attempts run in rounds and are accepted in index order, which keeps the result independent of scheduling
+    uint64_t round = static_cast<uint64_t>(threads) * 4;
+    std::vector<GeneratedPuzzle> puzzles;
+    std::unordered_set<std::string> seen;
+    for (uint64_t first = 0; first < limit && puzzles.size() < options.count; first += round) {
+        size_t batch = static_cast<size_t>(std::min(round, limit - first));
+        std::vector<GeneratedPuzzle> found(batch);
+        std::vector<char> accepted(batch, 0);
+        run_work_queue(batch, threads, [&](size_t i) { accepted[i] = attempt(first + i, found[i]); });
+        for (size_t i = 0; i < batch && puzzles.size() < options.count; ++i) {
+            if (accepted[i] && seen.insert(found[i].cells).second) {
+                puzzles.push_back(std::move(found[i]));
+            }
+        }
+    }
+    return puzzles;
+}
+
+void PuzzleGenerator::write_corpus(std::ostream& out, const std::vector<GeneratedPuzzle>& puzzles) const {
+    out << "# seed " << options.seed << ", at least " << options.min_moves << " moves, "
+        << options.min_pieces << "-" << options.max_pieces << " pieces\n";
+    out << options.rows << " " << options.cols << "\n";
+    for (const auto& puzzle : puzzles) {
+        out << puzzle.moves << " " << puzzle.cells << " " << puzzle.component_size << "\n";
+    }
+}
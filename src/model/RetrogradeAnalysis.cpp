@@ -0,0 +1,247 @@
+#include "RetrogradeAnalysis.hpp"
+#include "Algorithms.hpp"
+#include <map>
+
+namespace {
+    std::vector<int> order_from_start(const PieceTable& table, const State& start) {
+        std::vector<int> order(table.size(), 0);
+        for (int i = 0; i < table.size(); ++i) {
+            const PieceInfo& info = table.get_pieces()[i];
+            for (int j = 0; j < table.size(); ++j) {
+                const PieceInfo& other = table.get_pieces()[j];
+                if (other.orientation == info.orientation && other.lane == info.lane && start.offsets[j] < start.offsets[i]) {
+                    order[i]++;
+                }
+            }
+        }
+        return order;
+    }
+}
+
+StateRanker::StateRanker(const PieceTable& table, const State& start) : StateRanker(table, order_from_start(table, start)) {}
+
+StateRanker::StateRanker(const PieceTable& table, const std::vector<int>& lane_order) : table(&table) {
+    std::map<std::pair<int, int>, std::vector<int>> by_lane;
+    for (int i = 0; i < table.size(); ++i) {
+        const PieceInfo& info = table.get_pieces()[i];
+        by_lane[{info.orientation == Orientation::HORIZONTAL ? 0 : 1, info.lane}].push_back(i);
+    }
+    int largest = 0;
+    for (const auto& [key, pieces] : by_lane) {
+        largest = std::max(largest, table.get_pieces()[pieces.front()].lane_size);
+    }
+    binomial.assign(largest + 1, std::vector<uint64_t>(largest + 1, 0));
+    for (int n = 0; n <= largest; ++n) {
+        binomial[n][0] = 1;
+        for (int k = 1; k <= n; ++k) {
+            // Saturate instead of overflowing; such lanes are rejected below anyway
+            binomial[n][k] = std::min(binomial[n - 1][k - 1] + binomial[n - 1][k], RetrogradeAnalysis::MAX_RANKS + 1);
+        }
+    }
+    for (auto& [key, pieces] : by_lane) {
+        std::sort(pieces.begin(), pieces.end(), [&](int a, int b) { return lane_order[a] < lane_order[b]; });
+        int slots = table.get_pieces()[pieces.front()].lane_size;
+        for (int i : pieces) {
+            slots -= table.get_pieces()[i].length - 1;
+        }
+        Lane lane{pieces, slots, choose(slots, static_cast<int>(pieces.size())), total};
+        if (lane.count == 0 || total > RetrogradeAnalysis::MAX_RANKS / lane.count) {
+            throw RetrogradeException("State space too large to rank: more than " + std::to_string(RetrogradeAnalysis::MAX_RANKS) + " layouts");
+        }
+        total *= lane.count;
+        lanes.push_back(std::move(lane));
+    }
+}
+
+std::vector<int> StateRanker::lane_order() const {
+    std::vector<int> order(table->size(), 0);
+    for (const auto& lane : lanes) {
+        for (size_t i = 0; i < lane.pieces.size(); ++i) {
+            order[lane.pieces[i]] = static_cast<int>(i);
+        }
+    }
+    return order;
+}
+
+bool StateRanker::rank(const State& state, uint64_t& result) const {
+    result = 0;
+    for (const auto& lane : lanes) {
+        uint64_t lane_rank = 0;
+        int shift = 0;
+        int previous = -1;
+        for (size_t i = 0; i < lane.pieces.size(); ++i) {
+            int slot = state.offsets[lane.pieces[i]] - shift;
+            if (slot <= previous) {
+                return false;
+            }
+            lane_rank += choose(slot, static_cast<int>(i) + 1);
+            shift += table->get_pieces()[lane.pieces[i]].length - 1;
+            previous = slot;
+        }
+        result += lane_rank * lane.stride;
+    }
+    return true;
+}
+
+State StateRanker::unrank(uint64_t rank) const {
+    State state;
+    for (const auto& lane : lanes) {
+        uint64_t lane_rank = (rank / lane.stride) % lane.count;
+        std::vector<int> slots(lane.pieces.size());
+        int slot = lane.slots;
+        for (int i = static_cast<int>(lane.pieces.size()) - 1; i >= 0; --i) {
+            do {
+                slot--;
+            } while (choose(slot, i + 1) > lane_rank);
+            slots[i] = slot;
+            lane_rank -= choose(slot, i + 1);
+        }
+        int shift = 0;
+        for (size_t i = 0; i < lane.pieces.size(); ++i) {
+            int piece = lane.pieces[i];
+            state.offsets[piece] = static_cast<uint8_t>(slots[i] + shift);
+            state.hash ^= table->zobrist_key(piece, state.offsets[piece]);
+            shift += table->get_pieces()[piece].length - 1;
+        }
+    }
+    return state;
+}
+
+RetrogradeAnalysis::RetrogradeAnalysis(std::shared_ptr<const PieceTable> table, const State& start, SolverObserver* observer,
+                                       BudgetGuard* guard)
+    : table(std::move(table)), ranker(*this->table, start) {
+    distances.assign(ranker.size(), OUTSIDE);
+    std::vector<uint32_t> layer;
+    std::vector<uint32_t> next_layer;
+    std::vector<Move> moves;
+    uint64_t expanded = 0;  // Over both sweeps, for the guard
+    auto memory = [&] { return distances.capacity() * sizeof(uint16_t) + (layer.capacity() + next_layer.capacity()) * sizeof(uint32_t); };
+    uint64_t start_rank = 0;
+    ranker.rank(start, start_rank);
+
+    // Forward sweep: mark the component and collect its goals
+    std::vector<uint32_t> goals;
+    distances[start_rank] = UNSOLVABLE;
+    layer.push_back(static_cast<uint32_t>(start_rank));
+    while (!layer.empty()) {
+        next_layer.clear();
+        for (uint32_t rank : layer) {
+            if (guard && guard->exceeded(expanded++, memory)) {
+                return;
+            }
+            component_size++;
+            State state = ranker.unrank(rank);
+            if (observer) {
+                observer->on_expand(*this->table, state);
+            }
+            if (this->table->is_goal(state)) {
+                goals.push_back(rank);
+            }
+            this->table->get_moves(state, moves);
+            for (const auto& move : moves) {
+                State next = state;
+                this->table->apply_move(next, move);
+                uint64_t next_rank = 0;
+                ranker.rank(next, next_rank);
+                if (distances[next_rank] == OUTSIDE) {
+                    distances[next_rank] = UNSOLVABLE;
+                    next_layer.push_back(static_cast<uint32_t>(next_rank));
+                }
+            }
+        }
+        layer.swap(next_layer);
+    }
+
+    // Backward BFS from every goal at once; moves are reversible so successors double as predecessors
+    layer = std::move(goals);
+    for (uint32_t rank : layer) {
+        distances[rank] = 0;
+    }
+    for (uint16_t depth = 0; !layer.empty(); ++depth) {
+        if (depth == UNSOLVABLE) {
+            throw RetrogradeException("Goal distances too large to store");
+        }
+        solvable_states += layer.size();
+        hardest_distance = depth;
+        hardest_state = ranker.unrank(layer.front());
+        next_layer.clear();
+        for (uint32_t rank : layer) {
+            if (guard && guard->exceeded(expanded++, memory)) {
+                return;
+            }
+            State state = ranker.unrank(rank);
+            this->table->get_moves(state, moves);
+            for (const auto& move : moves) {
+                State next = state;
+                this->table->apply_move(next, move);
+                uint64_t next_rank = 0;
+                ranker.rank(next, next_rank);
+                if (distances[next_rank] == UNSOLVABLE) {
+                    distances[next_rank] = depth + 1;
+                    next_layer.push_back(static_cast<uint32_t>(next_rank));
+                }
+            }
+        }
+        layer.swap(next_layer);
+    }
+}
+
+int RetrogradeAnalysis::distance(const State& state) const {
+    uint64_t rank = 0;
+    if (!ranker.rank(state, rank)) {
+        return -1;
+    }
+    uint16_t value = distances[rank];
+    return value >= UNSOLVABLE ? -1 : value;
+}
+
+std::vector<State> RetrogradeAnalysis::solution(const State& state) const {
+    std::vector<State> path;
+    int remaining = distance(state);
+    if (remaining < 0) {
+        return path;
+    }
+    path.push_back(state);
+    std::vector<Move> moves;
+    State current = state;
+    while (remaining > 0) {
+        table->get_moves(current, moves);
+        for (const auto& move : moves) {
+            State next = current;
+            table->apply_move(next, move);
+            if (distance(next) == remaining - 1) {
+                current = next;
+                break;
+            }
+        }
+        path.push_back(current);
+        remaining--;
+    }
+    return path;
+}
+
+Algorithms::Result Retrograde::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    BudgetGuard guard(budget);
+    auto table = std::make_shared<const PieceTable>(board);
+    State start = table->encode(board);
+    RetrogradeAnalysis analysis(table, start, observer.get(), &guard);
+    std::vector<Steps> path;
+    if (!guard.stopped()) {
+        for (const auto& state : analysis.solution(start)) {
+            path.emplace_back(table, state);
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    std::vector<std::pair<std::string, long long>> extra_stats = {
+        {"Component size", static_cast<long long>(analysis.get_component_size())},
+        {"Solvable states", static_cast<long long>(analysis.get_solvable_states())},
+        {"Hardest state distance", analysis.get_hardest_distance()},
+        {"Rank table entries", static_cast<long long>(analysis.get_table_size())},
+    };
+    int move_count = path.empty() ? 0 : static_cast<int>(path.size()) - 1;
+    Result result = {path, move_count, static_cast<int>(analysis.get_component_size()), elapsed_time.count(), extra_stats};
+    result.status = guard.get_status();
+    return result;
+}
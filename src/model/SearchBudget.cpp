@@ -0,0 +1,16 @@
+#include "SearchBudget.hpp"
+
+BudgetGuard::BudgetGuard(const SearchBudget& budget, std::chrono::steady_clock::time_point start) : budget(budget) {
+    deadline = start +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(budget.seconds));
+}
+
+void BudgetGuard::check(size_t memory_bytes) {
+    if (budget.cancellation && budget.cancellation->is_cancelled()) {
+        status = SolveStatus::CANCELLED;
+    } else if (budget.seconds > 0.0 && std::chrono::steady_clock::now() >= deadline) {
+        status = SolveStatus::BUDGET_EXCEEDED;
+    } else if (budget.memory_megabytes > 0 && memory_bytes >= budget.memory_megabytes * (size_t(1) << 20)) {
+        status = SolveStatus::BUDGET_EXCEEDED;
+    }
+}
@@ -0,0 +1,49 @@
+#include "SearchStats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sys/resource.h>
+
+#ifdef RUSHHOUR_SEARCH_STATS
+void SearchStats::merge(const SearchStats& other) {
+    generated_nodes += other.generated_nodes;
+    duplicates += other.duplicates;
+    reopenings += other.reopenings;
+    open_updates += other.open_updates;
+    open_peak += other.open_peak;
+    closed_nodes += other.closed_nodes;
+    closed_peak += other.closed_peak;
+    memory_bytes += other.memory_bytes;
+    memory_states += other.memory_states;
+    for (int phase = 0; phase < PHASE_COUNT; ++phase) {
+        seconds[phase] += other.seconds[phase];
+    }
+}
+
+void SearchStats::append_to(std::vector<std::pair<std::string, long long>>& extra_stats) const {
+    auto micros = [](double s) { return static_cast<long long>(std::llround(s * 1e6)); };
+    extra_stats.push_back({"Nodes generated", static_cast<long long>(generated_nodes)});
+    extra_stats.push_back({"Duplicates pruned", static_cast<long long>(duplicates)});
+    extra_stats.push_back({"Re-openings", static_cast<long long>(reopenings)});
+    extra_stats.push_back({"Open-list updates", static_cast<long long>(open_updates)});
+    extra_stats.push_back({"Peak open list size", static_cast<long long>(open_peak)});
+    extra_stats.push_back({"Peak closed set size", static_cast<long long>(closed_peak)});
+    extra_stats.push_back({"Bytes per state", memory_states == 0 ? 0 : static_cast<long long>(memory_bytes / memory_states)});
+    extra_stats.push_back({"Peak RSS (KB)", peak_rss_kb()});
+    extra_stats.push_back({"Expansion time (us)", micros(seconds[EXPANSION])});
+    extra_stats.push_back({"Hashing time (us)", micros(seconds[HASHING])});
+    extra_stats.push_back({"Heuristic time (us)", micros(seconds[HEURISTIC])});
+    extra_stats.push_back({"Queue time (us)", micros(seconds[QUEUE])});
+}
+#endif
+
+long long SearchStats::peak_rss_kb() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;     // Reported in bytes there
+#else
+    return usage.ru_maxrss;
+#endif
+}
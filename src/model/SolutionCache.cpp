@@ -0,0 +1,155 @@
+#include "SolutionCache.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+    const std::string FILE_HEADER = "RUSHHOUR-SOLUTION-CACHE 1";
+}
+
+SolutionCache::SolutionCache(size_t capacity, const std::string& filepath) : capacity(std::max<size_t>(capacity, 1)), filepath(filepath) {
+    if (!filepath.empty()) {
+        load();
+    }
+}
+
+// Pieces in PieceTable order with their lane and offset, so two boards share a key exactly when
+// they encode to the same State over the same PieceTable
+std::string SolutionCache::make_key(const Board& board, const std::string& algorithm, const std::string& heuristics,
+                                    const std::string& parameters) {
+    PieceTable table(board);
+    State state = table.encode(board);
+    std::ostringstream key;
+    key << table.get_rows() << 'x' << table.get_cols() << '@' << table.get_goal_pos().row << ',' << table.get_goal_pos().col;
+    for (int i = 0; i < table.size(); ++i) {
+        const PieceInfo& info = table.get_pieces()[i];
+        key << ';' << info.id << ',' << info.length << ',' << (info.orientation == Orientation::HORIZONTAL ? 'h' : 'v')
+            << ',' << info.lane << ',' << static_cast<int>(state.offsets[i]);
+    }
+    key << '|' << algorithm << '|' << heuristics << '|' << parameters;
+    return key.str();
+}
+
+bool SolutionCache::find(const std::string& key, Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    entry = *it->second;
+    return true;
+}
+
+void SolutionCache::insert(Entry entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(entry.key);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front(std::move(entry));
+    index[entries.front().key] = entries.begin();
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void SolutionCache::evict(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    entries.erase(it->second);
+    index.erase(it);
+    hits--;
+    misses++;
+}
+
+// One tab-separated line per entry, most recently used first:
+// key, solved, states explored, time, move count, moves as piece:from:to, then name=value stats.
+// Written to a temporary file that replaces the old one, so a failed save leaves the old cache intact.
+void SolutionCache::save() const {
+    if (filepath.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string temporary = filepath + ".tmp";
+    std::ofstream file(temporary, std::ios::trunc);
+    if (!file.is_open()) {
+        throw SolutionCacheException("Could not write solution cache: " + filepath);
+    }
+    file << FILE_HEADER << '\n';
+    for (const auto& entry : entries) {
+        file << entry.key << '\t' << entry.solved << '\t' << entry.states_explored << '\t' << entry.time_taken << '\t' << entry.moves.size();
+        for (const auto& move : entry.moves) {
+            file << '\t' << static_cast<int>(move.piece) << ':' << static_cast<int>(move.from) << ':' << static_cast<int>(move.to);
+        }
+        for (const auto& [name, value] : entry.extra_stats) {
+            file << '\t' << name << '=' << value;
+        }
+        file << '\n';
+    }
+    file.close();
+    std::error_code error;
+    if (file) {
+        std::filesystem::rename(temporary, filepath, error);
+    }
+    if (!file || error) {
+        std::filesystem::remove(temporary, error);
+        throw SolutionCacheException("Could not write solution cache: " + filepath);
+    }
+}
+
+void SolutionCache::load() {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        return;
+    }
+    std::string line;
+    if (!std::getline(file, line) || line != FILE_HEADER) {
+        throw SolutionCacheException("Not a solution cache file: " + filepath);
+    }
+    while (std::getline(file, line) && entries.size() < capacity) {
+        std::vector<std::string> fields;
+        std::istringstream stream(line);
+        std::string field;
+        while (std::getline(stream, field, '\t')) {
+            fields.push_back(field);
+        }
+        try {
+            Entry entry;
+            entry.key = fields.at(0);
+            entry.solved = std::stoi(fields.at(1)) != 0;
+            entry.states_explored = std::stoi(fields.at(2));
+            entry.time_taken = std::stod(fields.at(3));
+            size_t move_count = std::stoul(fields.at(4));
+            for (size_t i = 0; i < move_count; ++i) {
+                int piece = 0, from = 0, to = 0;
+                char colon = 0;
+                std::istringstream move(fields.at(5 + i));
+                if (!(move >> piece >> colon >> from >> colon >> to)) {
+                    throw SolutionCacheException("Bad move");
+                }
+                entry.moves.push_back({static_cast<uint8_t>(piece), static_cast<uint8_t>(from), static_cast<uint8_t>(to)});
+            }
+            for (size_t i = 5 + move_count; i < fields.size(); ++i) {
+                size_t split = fields[i].rfind('=');
+                if (split == std::string::npos) {
+                    throw SolutionCacheException("Bad statistic");
+                }
+                entry.extra_stats.push_back({fields[i].substr(0, split), std::stoll(fields[i].substr(split + 1))});
+            }
+            if (index.count(entry.key) == 0) {
+                entries.push_back(std::move(entry));
+                index[entries.back().key] = std::prev(entries.end());
+            }
+        } catch (const std::exception&) {
+            throw SolutionCacheException("Corrupt solution cache line in " + filepath + ": " + line);
+        }
+    }
+}
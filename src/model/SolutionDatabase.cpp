@@ -0,0 +1,193 @@
+#include "SolutionDatabase.hpp"
+#include "Algorithms.hpp"
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr char MAGIC[8] = {'R', 'H', 'S', 'O', 'L', 'D', 'B', '\0'};
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    uint64_t align8(uint64_t offset) {
+        return (offset + 7) & ~uint64_t(7);
+    }
+}
+
+SolutionDatabase::SolutionDatabase(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw SolutionDatabaseException("Could not open solution database: " + path);
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        throw SolutionDatabaseException("Not a solution database: " + path);
+    }
+    length = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        throw SolutionDatabaseException("Could not map solution database: " + path);
+    }
+    data = static_cast<const unsigned char*>(mapped);
+    header = reinterpret_cast<const FileHeader*>(data);
+
+    std::string problem;
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        problem = "Not a solution database: ";
+    } else if (header->byte_order != BYTE_ORDER_MARK) {
+        problem = "Solution database written with a different byte order: ";
+    } else if (header->version != VERSION) {
+        problem = "Unsupported solution database version " + std::to_string(header->version) + ": ";
+    } else if (header->ranking != RANKING_LANE_COMBINATIONS) {
+        problem = "Unsupported state ranking in solution database: ";
+    } else if (header->distances_offset < sizeof(FileHeader) + header->piece_count * sizeof(PieceRecord) ||
+               header->distances_offset % 8 != 0 || header->distances_offset > length ||
+               header->rank_count > (length - header->distances_offset) / sizeof(uint16_t)) {
+        problem = "Truncated solution database: ";
+    }
+    if (!problem.empty()) {
+        ::munmap(const_cast<unsigned char*>(data), length);
+        throw SolutionDatabaseException(problem + path);
+    }
+    records = reinterpret_cast<const PieceRecord*>(data + sizeof(FileHeader));
+    distances = reinterpret_cast<const uint16_t*>(data + header->distances_offset);
+}
+
+SolutionDatabase::~SolutionDatabase() {
+    if (data) {
+        ::munmap(const_cast<unsigned char*>(data), length);
+    }
+}
+
+void SolutionDatabase::write(const std::string& path, const RetrogradeAnalysis& analysis) {
+    const PieceTable& table = *analysis.get_table();
+    FileHeader out{};
+    std::memcpy(out.magic, MAGIC, sizeof(MAGIC));
+    out.version = VERSION;
+    out.byte_order = BYTE_ORDER_MARK;
+    out.rows = static_cast<uint16_t>(table.get_rows());
+    out.cols = static_cast<uint16_t>(table.get_cols());
+    out.goal_row = static_cast<int16_t>(table.get_goal_pos().row);
+    out.goal_col = static_cast<int16_t>(table.get_goal_pos().col);
+    out.piece_count = static_cast<uint16_t>(table.size());
+    out.ranking = RANKING_LANE_COMBINATIONS;
+    out.rank_count = analysis.get_table_size();
+    out.distances_offset = align8(sizeof(FileHeader) + table.size() * sizeof(PieceRecord));
+
+    std::vector<int> order = analysis.get_ranker().lane_order();
+    std::vector<PieceRecord> pieces(table.size());
+    for (int i = 0; i < table.size(); ++i) {
+        const PieceInfo& info = table.get_pieces()[i];
+        if (info.id.size() > sizeof(pieces[i].id)) {
+            throw SolutionDatabaseException("Piece id too long for a solution database: " + info.id);
+        }
+        std::memset(pieces[i].id, 0, sizeof(pieces[i].id));
+        std::memcpy(pieces[i].id, info.id.data(), info.id.size());
+        pieces[i].length = static_cast<uint8_t>(info.length);
+        pieces[i].orientation = info.orientation == Orientation::HORIZONTAL ? 0 : 1;
+        pieces[i].lane = static_cast<uint8_t>(info.lane);
+        pieces[i].lane_position = static_cast<uint8_t>(order[i]);
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw SolutionDatabaseException("Could not create solution database: " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&out), sizeof(out));
+    file.write(reinterpret_cast<const char*>(pieces.data()), pieces.size() * sizeof(PieceRecord));
+    std::vector<char> padding(out.distances_offset - sizeof(FileHeader) - pieces.size() * sizeof(PieceRecord), 0);
+    file.write(padding.data(), padding.size());
+    const std::vector<uint16_t>& table_distances = analysis.get_distances();
+    file.write(reinterpret_cast<const char*>(table_distances.data()), table_distances.size() * sizeof(uint16_t));
+    if (!file) {
+        throw SolutionDatabaseException("Could not write solution database: " + path);
+    }
+}
+
+bool SolutionDatabase::same_piece(const PieceRecord& record, const PieceInfo& info) const {
+    return std::string(record.id, strnlen(record.id, sizeof(record.id))) == info.id &&
+           record.length == info.length &&
+           record.orientation == (info.orientation == Orientation::HORIZONTAL ? 0 : 1) &&
+           record.lane == info.lane;
+}
+
+bool SolutionDatabase::matches(const PieceTable& table) const {
+    if (header->rows != table.get_rows() || header->cols != table.get_cols() ||
+        header->goal_row != table.get_goal_pos().row || header->goal_col != table.get_goal_pos().col ||
+        header->piece_count != table.size()) {
+        return false;
+    }
+    for (int i = 0; i < table.size(); ++i) {
+        if (!same_piece(records[i], table.get_pieces()[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+StateRanker SolutionDatabase::make_ranker(const PieceTable& table) const {
+    if (!matches(table)) {
+        throw SolutionDatabaseException("Solution database was built for a different puzzle");
+    }
+    std::vector<int> order(table.size());
+    for (int i = 0; i < table.size(); ++i) {
+        order[i] = records[i].lane_position;
+    }
+    StateRanker ranker(table, order);
+    if (ranker.size() != header->rank_count) {
+        throw SolutionDatabaseException("Solution database ranks a different number of states");
+    }
+    return ranker;
+}
+
+int SolutionDatabase::distance(const StateRanker& ranker, const State& state) const {
+    uint64_t rank = 0;
+    if (!ranker.rank(state, rank)) {
+        return -1;
+    }
+    uint16_t value = distances[rank];
+    return value >= RetrogradeAnalysis::UNSOLVABLE ? -1 : value;
+}
+
+bool SolutionDatabase::best_move(const PieceTable& table, const StateRanker& ranker, const State& state, Move& move) const {
+    int remaining = distance(ranker, state);
+    if (remaining <= 0) {
+        return false;
+    }
+    std::vector<Move> moves;
+    table.get_moves(state, moves);
+    for (const auto& candidate : moves) {
+        State next = state;
+        table.apply_move(next, candidate);
+        if (distance(ranker, next) == remaining - 1) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+Algorithms::Result DatabaseLookup::solve(const Board& board) {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto table = std::make_shared<const PieceTable>(board);
+    State state = table->encode(board);
+    StateRanker ranker = database->make_ranker(*table);
+    std::vector<Steps> path;
+    if (database->distance(ranker, state) >= 0) {
+        path.emplace_back(table, state);
+        Move move;
+        while (database->best_move(*table, ranker, state, move)) {
+            observer->on_expand(*table, state);
+            table->apply_move(state, move);
+            path.emplace_back(table, state);
+        }
+    }
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed_time = end_time - start_time;
+    int move_count = path.empty() ? 0 : static_cast<int>(path.size()) - 1;
+    return {path, move_count, move_count, elapsed_time.count(), {{"Database states", static_cast<long long>(database->size())}}};
+}
@@ -0,0 +1,23 @@
+#include "SolverObserver.hpp"
+
+SampledVisualizer::SampledVisualizer(int max_fps) : last_draw() {
+    if (max_fps <= 0) {
+        max_fps = 1;
+    }
+    interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::seconds(1)) / max_fps;
+}
+
+void SampledVisualizer::on_expand(const PieceTable& table, const State& state) {
+    count++;
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_draw < interval) {
+        return;
+    }
+    last_draw = now;
+    // ANSI clear-screen and cursor-home instead of forking a shell for `clear`
+    std::cout << "\033[2J\033[H" << table.decode(state).to_string() << "States explored: " << count << std::endl;
+}
+
+void SampledVisualizer::on_solution(int move_count, double bound) {
+    std::cout << "Solution with " << move_count << " moves, at most " << bound << " times optimal" << std::endl;
+}
@@ -0,0 +1,271 @@
+#include "State.hpp"
+#include <functional>
+#include <random>
+
+PieceTable::PieceTable(const Board& board) : rows(board.get_rows()), cols(board.get_cols()), goal_pos(board.get_goal_pos()), primary(-1) {
+    if (rows * cols > MAX_CELLS || rows > 255 || cols > 255) {
+        throw StateException("Board too large for compact state: " + std::to_string(rows) + "x" + std::to_string(cols));
+    }
+    if (board.get_pieces().size() > static_cast<size_t>(MAX_PIECES)) {
+        throw StateException("Too many pieces for compact state: " + std::to_string(board.get_pieces().size()));
+    }
+    for (const auto& [id, piece] : board.get_pieces()) {
+        PieceInfo info;
+        info.id = id;
+        info.length = piece->get_length();
+        info.orientation = piece->get_orientation();
+        info.color = piece->get_color();
+        if (info.orientation == Orientation::HORIZONTAL) {
+            info.lane = piece->get_head().row;
+            info.lane_size = cols;
+        } else {
+            info.lane = piece->get_head().col;
+            info.lane_size = rows;
+        }
+        if (id == "P") {
+            primary = static_cast<int>(pieces.size());
+        }
+        pieces.push_back(info);
+    }
+    goal_min = 1;
+    goal_max = 0;
+    if (primary != -1) {
+        const PieceInfo& info = pieces[primary];
+        bool on_lane = info.orientation == Orientation::HORIZONTAL ? goal_pos.row == info.lane : goal_pos.col == info.lane;
+        if (on_lane) {
+            int goal_offset = info.orientation == Orientation::HORIZONTAL ? goal_pos.col : goal_pos.row;
+            goal_min = std::max(0, goal_offset - info.length + 1);
+            goal_max = goal_offset;
+        }
+    }
+    // Fixed seed so hashes, and therefore tie-breaking in the open lists, are reproducible between runs
+    lane_stride = std::max(rows, cols);
+    std::mt19937_64 rng(0x5275736848ULL);
+    zobrist.resize(pieces.size() * lane_stride);
+    for (auto& key : zobrist) {
+        key = rng();
+    }
+}
+
+Position PieceTable::get_head(const State& state, int piece) const {
+    const PieceInfo& info = pieces[piece];
+    if (info.orientation == Orientation::HORIZONTAL) {
+        return Position(info.lane, state.offsets[piece]);
+    }
+    return Position(state.offsets[piece], info.lane);
+}
+
+State PieceTable::encode(const Board& board) const {
+    State state;
+    for (int i = 0; i < size(); ++i) {
+        auto piece = board.get_piece(pieces[i].id);
+        if (!piece) {
+            throw StateException("Piece " + pieces[i].id + " missing from board");
+        }
+        Position head = piece->get_head();
+        state.offsets[i] = static_cast<uint8_t>(pieces[i].orientation == Orientation::HORIZONTAL ? head.col : head.row);
+        state.hash ^= zobrist_key(i, state.offsets[i]);
+    }
+    return state;
+}
+
+Board PieceTable::decode(const State& state) const {
+    Board board(rows, cols, goal_pos);
+    for (int i = 0; i < size(); ++i) {
+        const PieceInfo& info = pieces[i];
+        board.add_piece(std::make_shared<Piece>(info.id, info.length, get_head(state, i), info.orientation, info.color));
+    }
+    return board;
+}
+
+Bitboard PieceTable::occupancy(const State& state) const {
+    Bitboard occupied;
+    for (int i = 0; i < size(); ++i) {
+        int cell = cell_index(i, state.offsets[i]);
+        int step = cell_step(i);
+        for (int k = 0; k < pieces[i].length; ++k, cell += step) {
+            occupied.set(cell);
+        }
+    }
+    return occupied;
+}
+
+OwnerGrid PieceTable::owners(const State& state) const {
+    OwnerGrid grid;
+    std::fill(grid.begin(), grid.begin() + rows * cols, -1);
+    for (int i = 0; i < size(); ++i) {
+        int cell = cell_index(i, state.offsets[i]);
+        int step = cell_step(i);
+        for (int k = 0; k < pieces[i].length; ++k, cell += step) {
+            grid[cell] = static_cast<int8_t>(i);
+        }
+    }
+    return grid;
+}
+
+int PieceTable::count_positions(const State& state, const Bitboard& occupied, int piece) const {
+    const PieceInfo& info = pieces[piece];
+    int offset = state.offsets[piece];
+    int step = cell_step(piece);
+    int count = 0;
+    for (int o = offset - 1; o >= 0 && !occupied.test(cell_index(piece, o)); --o) {
+        count++;
+    }
+    int tail = cell_index(piece, offset) + info.length * step;
+    for (int o = offset + 1; o + info.length <= info.lane_size && !occupied.test(tail); ++o, tail += step) {
+        count++;
+    }
+    return count;
+}
+
+void PieceTable::get_moves(const State& state, std::vector<Move>& moves) const {
+    moves.clear();
+    Bitboard occupied = occupancy(state);
+    for (int i = 0; i < size(); ++i) {
+        const PieceInfo& info = pieces[i];
+        uint8_t offset = state.offsets[i];
+        int step = cell_step(i);
+        // Slide towards the start of the lane until blocked
+        for (int o = offset - 1; o >= 0 && !occupied.test(cell_index(i, o)); --o) {
+            moves.push_back({static_cast<uint8_t>(i), offset, static_cast<uint8_t>(o)});
+        }
+        // Slide towards the end of the lane, checking the cell just past the tail
+        int tail = cell_index(i, offset) + info.length * step;
+        for (int o = offset + 1; o + info.length <= info.lane_size && !occupied.test(tail); ++o, tail += step) {
+            moves.push_back({static_cast<uint8_t>(i), offset, static_cast<uint8_t>(o)});
+        }
+    }
+}
+
+bool PieceTable::is_goal(const State& state) const {
+    if (primary == -1) {
+        return false;
+    }
+    int offset = state.offsets[primary];
+    return offset >= goal_min && offset <= goal_max;
+}
+
+// Every legal layout with the primary car on the goal that could still be reachable from start,
+// found by placing pieces one at a time and skipping overlaps. Pieces sharing a lane can never pass
+// each other, so layouts that change their order are skipped too. Gives up and returns false once
+// more than limit layouts exist.
+bool PieceTable::enumerate_goals(const State& start, std::vector<State>& goals, size_t limit) const {
+    goals.clear();
+    if (primary == -1 || goal_min > goal_max) {
+        return true;
+    }
+    std::vector<std::vector<int>> lane_mates(pieces.size());
+    for (int i = 0; i < size(); ++i) {
+        for (int j = 0; j < i; ++j) {
+            if (pieces[i].orientation == pieces[j].orientation && pieces[i].lane == pieces[j].lane) {
+                lane_mates[i].push_back(j);
+            }
+        }
+    }
+    State state;
+    Bitboard occupied;
+    std::function<bool(int)> place = [&](int piece) {
+        if (piece == size()) {
+            if (goals.size() >= limit) {
+                return false;
+            }
+            goals.push_back(state);
+            return true;
+        }
+        const PieceInfo& info = pieces[piece];
+        int first = piece == primary ? goal_min : 0;
+        int last = piece == primary ? std::min(goal_max, info.lane_size - info.length) : info.lane_size - info.length;
+        int step = cell_step(piece);
+        for (int offset = first; offset <= last; ++offset) {
+            int head = cell_index(piece, offset);
+            bool free = true;
+            for (int k = 0, cell = head; k < info.length; ++k, cell += step) {
+                if (occupied.test(cell)) {
+                    free = false;
+                    break;
+                }
+            }
+            for (int mate : lane_mates[piece]) {
+                if ((offset < state.offsets[mate]) != (start.offsets[piece] < start.offsets[mate])) {
+                    free = false;
+                }
+            }
+            if (!free) {
+                continue;
+            }
+            for (int k = 0, cell = head; k < info.length; ++k, cell += step) {
+                occupied.set(cell);
+            }
+            state.offsets[piece] = static_cast<uint8_t>(offset);
+            state.hash ^= zobrist_key(piece, offset);
+            bool within_limit = place(piece + 1);
+            state.hash ^= zobrist_key(piece, offset);
+            for (int k = 0, cell = head; k < info.length; ++k, cell += step) {
+                occupied.reset(cell);
+            }
+            if (!within_limit) {
+                return false;
+            }
+        }
+        return true;
+    };
+    return place(0);
+}
+
+// The hash Steps used before Zobrist keys, kept so the hash debug report can compare the two
+size_t PieceTable::legacy_hash(const State& state) const {
+    size_t result = 0;
+    const size_t prime = 31;
+    for (int i = 0; i < size(); ++i) {
+        Position pos = get_head(state, i);
+        size_t piece_hash = std::hash<std::string>{}(pieces[i].id);
+        piece_hash = piece_hash * prime + std::hash<int>{}(pos.row);
+        piece_hash = piece_hash * prime + std::hash<int>{}(pos.col);
+        result = result * prime + piece_hash;
+    }
+    return result;
+}
+
+StateCodec::StateCodec(const PieceTable& table) : table(&table) {
+    int bits = 0;
+    for (const auto& info : table.get_pieces()) {
+        int width = 0;
+        while ((1 << width) < info.lane_size) {
+            width++;
+        }
+        // A field never straddles two words
+        if (bits % 64 + width > 64) {
+            bits += 64 - bits % 64;
+        }
+        widths.push_back(width);
+        bits += width;
+    }
+    words = std::max(1, (bits + 63) / 64);
+}
+
+void StateCodec::pack(const State& state, uint64_t* record) const {
+    std::fill(record, record + words, 0);
+    int bits = 0;
+    for (int i = 0; i < table->size(); ++i) {
+        if (bits % 64 + widths[i] > 64) {
+            bits += 64 - bits % 64;
+        }
+        record[bits / 64] |= static_cast<uint64_t>(state.offsets[i]) << (bits % 64);
+        bits += widths[i];
+    }
+}
+
+State StateCodec::unpack(const uint64_t* record) const {
+    State state;
+    int bits = 0;
+    for (int i = 0; i < table->size(); ++i) {
+        if (bits % 64 + widths[i] > 64) {
+            bits += 64 - bits % 64;
+        }
+        uint64_t mask = (uint64_t(1) << widths[i]) - 1;
+        state.offsets[i] = static_cast<uint8_t>((record[bits / 64] >> (bits % 64)) & mask);
+        state.hash ^= table->zobrist_key(i, state.offsets[i]);
+        bits += widths[i];
+    }
+    return state;
+}
@@ -41,6 +41,9 @@ ______ _____ _____ _   _ _    _____
     std::cout << "Solution found in " << solution.move_count << std::endl << "Moves." << std::endl;
     std::cout << "States explored: " << solution.states_explored << std::endl;
     std::cout << "Time taken: " << solution.time_taken << " seconds." << std::endl;
+    for (const auto& [name, value] : solution.extra_stats) {
+        std::cout << name << ": " << value << std::endl;
+    }
     std::cout << "Initial state:" << std::endl;
     std::cout << solution.path[0].to_string() << std::endl;
     pause();
@@ -49,6 +52,9 @@ ______ _____ _____ _   _ _    _____
         std::cout << "Solution found in " << solution.move_count << std::endl << "Moves." << std::endl;
         std::cout << "States explored: " << solution.states_explored << std::endl;
         std::cout << "Time taken: " << solution.time_taken << " seconds." << std::endl;
+        for (const auto& [name, value] : solution.extra_stats) {
+            std::cout << name << ": " << value << std::endl;
+        }
         std::cout << "Move " << i << std::endl;
         std::cout << solution.path[i].to_string() << std::endl;
         pause();
@@ -68,12 +74,45 @@ void ProgramView::display_main_menu(const Board& initial_board) {
     std::cout << "[Load Board]" << std::endl;
     std::cout << "[Run Solver]" << std::endl;
     std::cout << "[Exit]" << std::endl;
+    std::cout << "[Save Database]" << std::endl;
+    std::cout << "[Load Database]" << std::endl;
+}
+
+void ProgramView::display_database_prompt() {
+    std::cout << "Solution database file:" << std::endl;
 }
 
 void ProgramView::display_heuristics(){
     std::cout << "Available Heuristics:" << std::endl;
     std::cout << "1. Manhattan Distance" << std::endl;
     std::cout << "2. Blocked Car Heuristic" << std::endl;
+    std::cout << "3. Pattern Database" << std::endl;
+}
+
+void ProgramView::display_observer_modes(){
+    std::cout << "Search Display:" << std::endl;
+    std::cout << "1. None" << std::endl;
+    std::cout << "2. Live" << std::endl;
+    std::cout << "3. Counter" << std::endl;
+}
+
+void ProgramView::display_batch_usage() {
+    std::cerr << "Usage: RushHourV.1.0 --batch <dir|corpus> [--algo <algorithm>] [--heuristic <heuristic>] [--out <file.csv>] [--threads <n>] [--ida-tt-mb <n>] [--ext-mb <n>] [--ext-dir <dir>] [--beam-width <n>] [--time-limit <s>] [--node-limit <n>] [--memory-limit <mb>] [--db <file>] [--cache <file>] [--cache-size <n>]" << std::endl;
+    std::cerr << "  --algo       a*, ara*, ucs, gbfs, ida*, hda*, bibfs, external, beam, retrograde, database (default a*)" << std::endl;
+    std::cerr << "  --heuristic  blockedcarheuristic, manhattandistance, patterndatabase (default blockedcarheuristic)" << std::endl;
+    std::cerr << "  --out        CSV output path (default stdout)" << std::endl;
+    std::cerr << "  --threads    worker threads, 0 for one per core (default 0)" << std::endl;
+    std::cerr << "  --ida-tt-mb  largest IDA* transposition table in MB, 0 to disable (default 16); it grows as the" << std::endl;
+    std::cerr << "               search needs, and every worker thread has its own, so the total can reach threads x MB" << std::endl;
+    std::cerr << "  --ext-mb     RAM budget of the external-memory BFS in MB (default 64)" << std::endl;
+    std::cerr << "  --ext-dir    directory for its scratch files (default the system temporary directory)" << std::endl;
+    std::cerr << "  --beam-width states kept per layer by beam search (default 1024)" << std::endl;
+    std::cerr << "  --time-limit   seconds per puzzle before the search gives up (default unlimited)" << std::endl;
+    std::cerr << "  --node-limit   expansions per puzzle before the search gives up (default unlimited)" << std::endl;
+    std::cerr << "  --memory-limit MB of search tables per puzzle before the search gives up (default unlimited)" << std::endl;
+    std::cerr << "  --db         solution database used by --algo database" << std::endl;
+    std::cerr << "  --cache      reuse solved puzzles, kept in this file across runs" << std::endl;
+    std::cerr << "  --cache-size reuse solved puzzles, keeping this many most recently used (default 64)" << std::endl;
 }
 
 std::string ProgramView::get_user_input() {
@@ -100,6 +139,13 @@ void ProgramView::display_algorithms() {
     std::cout << "2. Greedy Best First Search" << std::endl;
     std::cout << "3. Uniform Cost Search" << std::endl;
     std::cout << "4. Iterative Deepening A*" << std::endl;
+    std::cout << "5. Hash Distributed A* (parallel)" << std::endl;
+    std::cout << "6. Bidirectional BFS" << std::endl;
+    std::cout << "7. Retrograde Analysis (whole state space)" << std::endl;
+    std::cout << "8. Solution Database (load one first)" << std::endl;
+    std::cout << "9. External BFS (spills to disk)" << std::endl;
+    std::cout << "10. Anytime A* (ARA*)" << std::endl;
+    std::cout << "11. Beam Search (very large boards)" << std::endl;
 }
 void ProgramView::display_loader() {
     std::system("clear");